@@ -1,65 +1,25 @@
 #ifndef A109110SHELLSORT_HPP
 #define A109110SHELLSORT_HPP
 
-#include <limits>
+#include <cstdint>
 #include "ShellSortTemplate.hpp"
-#include "IntegralConstantArithmetic.hpp"
+#include "GapTable.hpp"
 
 namespace A109110NS {
-    using namespace IntegralConstantArithmetic;
+    // a(n) = 2 a(n - 1) + a(n - 2) - a(n - 3) from 4, 9, 20, after a leading 1
+    inline constexpr std::intmax_t seeds[] = {1, 4, 9, 20};
+    inline constexpr auto next = [](const auto &f) { return f(1) * 2 + f(2) - f(3); };
 
-    template <class Numeric, size_t sz>
-    struct Number {
-        using type = substract_t< 
-                        add_t<
-                            multiply_t<typename Number<Numeric, sz - 1>::type, IC<Numeric, 2>>,
-                            typename Number<Numeric, sz - 2>::type>,
-                        typename Number<Numeric, sz - 3>::type>;
-    };
-    
-    template <class Numeric>
-    struct Number<Numeric, 0> {
-        using type = IC<Numeric, 4>;
-    };
-    
-    template <class Numeric>
-    struct Number<Numeric, 1> {
-        using type = IC<Numeric, 9>;
-    };
-    
     template <class Numeric>
-    struct Number<Numeric, 2> {
-        using type = IC<Numeric, 20>;
-    };
+    constexpr auto gaps = GapTable::table<Numeric, seeds, next>;
 
     template <class Numeric = int>
     class Sequence {
         // A109110 number generator
         //
-        
-        static constexpr size_t table_size() {
-            constexpr Numeric max_num = std::numeric_limits<Numeric>::max();
-            Numeric f0(4), f1(9), f2(20), f3(1);
-            constexpr auto two = IC<Numeric, 2>::value;
-            size_t sz = 3;
-            while (((max_num - f1 + f0) / two) >= f2) {
-                f3 = f2 * two + f1 - f0;
-                f0 = f1;
-                f1 = f2;
-                f2 = f3;
-                sz++;
-            }
-
-            return sz;
-        }
-
-        template <size_t ...I>
-        static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
-            return std::integer_sequence<Numeric, Number<Numeric, sizeof...(I) - I - 1>::type::value..., IC<Numeric, 1>::value>{};
-        }
 
         public:
-        using type = decltype(gen_seq(std::make_index_sequence<table_size()>())); 
+        using type = GapTable::sequence_t<gaps<Numeric>>;
     };
 
     template<class Iterator, class Comparator=std::less<>>
@@ -67,5 +27,10 @@ namespace A109110NS {
         ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
     }
 
+    template<class Iterator, class Comparator>
+    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp, threads);
+    }
+
 };
 #endif
@@ -0,0 +1,126 @@
+#ifndef AUTOSHELLSORT_HPP
+#define AUTOSHELLSORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+#include "ShellSortTemplate.hpp"
+#include "GapRegistry.hpp"
+
+namespace AutoSortNS {
+    // Elements probed for each estimate; smaller arrays are not profiled.
+    constexpr std::size_t sample_size = 1024;
+    constexpr std::size_t min_size = 1 << 14;
+
+    // Fractions of the sampled probes that came out a certain way:
+    struct Profile {
+        double descents;    // a[i + 1] before a[i]: 1/2 on random data, ~0 inside sorted runs
+        double inversions;  // a[j] before a[i] for distant j > i: ~0 when every element is near its place
+        double duplicates;  // equal neighbours in the sorted sample: ~0 for distinct keys
+    };
+
+    // Estimates the profile from sample_size probes of each kind, spread
+    // evenly over the array with a fixed pseudo-random jitter so that the
+    // result is reproducible.
+    template<class Iterator, class Compare>
+    Profile profile(Iterator first, const std::size_t size, Compare comp) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        const std::size_t step = size / sample_size;
+        std::uint64_t state = 0x9e3779b97f4a7c15u;
+        const auto jitter = [&state](std::size_t bound) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return std::size_t(state % bound);
+        };
+
+        std::size_t descents = 0, inversions = 0, duplicates = 0;
+        std::vector<value_type> sample;
+        sample.reserve(sample_size);
+
+        for (std::size_t k = 0; k < sample_size; k++) {
+            const std::size_t i = k * step + jitter(step - 1);
+            const std::size_t j = i + (size - i) / 2 + jitter((size - i) / 2);
+
+            descents += comp(*(first + (i + 1)), *(first + i));
+            inversions += comp(*(first + j), *(first + i));
+            sample.push_back(*(first + i));
+        }
+
+        std::sort(sample.begin(), sample.end(), comp);
+
+        for (std::size_t k = 1; k < sample_size; k++)
+            duplicates += !comp(sample[k - 1], sample[k]);
+
+        return {double(descents) / sample_size, double(inversions) / sample_size, double(duplicates) / sample_size};
+    }
+
+    // First rule whose bounds hold picks the sequence and the trim: gaps
+    // above size / trim are dropped. Calibrated on 1M int arrays of the
+    // benchmark's inputs plus sorted runs and local disorder, by comparisons
+    // per element (TokudaNS makes the fewest on nearly every input) and by
+    // time where a sequence wins it clearly; see README.
+    struct Rule {
+        double max_descents;
+        double max_inversions;
+        double min_duplicates;
+        std::string_view sequence;
+        std::size_t trim;
+    };
+
+    constexpr Rule rules[] = {
+        {0.10, 0.05, 0.00, "tokuda", 1},        // nearly sorted
+        {1.00, 0.05, 0.00, "ps65", 1},          // every element near its place
+        {0.10, 1.00, 0.00, "a109110", 16},      // long sorted runs
+        {1.00, 1.00, 0.50, "tokuda", 3},        // few distinct keys
+        {1.00, 1.00, 0.00, "tokuda", 1},        // random and skewed
+    };
+
+    // Profile fractions lie in [0, 1], so this rule holds for every one.
+    constexpr bool catch_all(const Rule &rule) noexcept {
+        return rule.max_descents >= 1.0 && rule.max_inversions >= 1.0 && rule.min_duplicates <= 0.0;
+    }
+
+    static_assert(catch_all(std::end(rules)[-1]), "the last rule must match every profile");
+
+    constexpr std::string_view default_sequence = "fib-fuzzy";
+
+    inline ShellSortTemplate::Gaps choose(const Profile &p, const std::size_t size) noexcept {
+        const Rule &rule = *std::find_if(std::begin(rules), std::end(rules), [&p](const Rule &r) {
+            return p.descents <= r.max_descents && p.inversions <= r.max_inversions && p.duplicates >= r.min_duplicates;
+        });
+        auto gaps = *GapRegistry::find(rule.sequence);
+
+        while (gaps.count > 1 && gaps.first[0] > size / rule.trim) {
+            gaps.first++;
+            gaps.count--;
+        }
+
+        return gaps;
+    }
+
+    // Profiles the array and sorts it with the gap table the rules pick;
+    // arrays below min_size take the default sequence unprofiled.
+    template<class Iterator, class Comparator = std::less<>, class Policy = ShellSortTemplate::DefaultPolicy>
+    void sort(Iterator first, Iterator last, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        const std::size_t size = std::distance(first, last);
+        auto gaps = *GapRegistry::find(default_sequence);
+
+        if (size >= min_size)
+            gaps = choose(profile(first, size, comp), size);
+
+        ShellSortTemplate::sort<Iterator, Comparator, Policy>(first, last, gaps, comp, threads);
+    }
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        AutoSortNS::sort<Iterator, Comparator>(first, last, comp);
+    }
+
+};
+
+#endif
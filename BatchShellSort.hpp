@@ -0,0 +1,177 @@
+#ifndef BATCHSHELLSORT_HPP
+#define BATCHSHELLSORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace BatchSortNS {
+    // Longest array a schedule can index.
+    constexpr std::size_t max_length = 0xffff;
+
+    // Batcher's odd-even merge network for `length` elements, every
+    // comparator packed as i << 16 | j.
+    inline std::vector<std::uint32_t> schedule(const std::size_t length) {
+        std::vector<std::uint32_t> pairs;
+
+        ShellSortTemplate::Network::batcher(length, [&pairs](std::size_t i, std::size_t j) {
+            pairs.push_back(std::uint32_t(i << 16 | j));
+        });
+
+        return pairs;
+    }
+
+#ifdef SHELLSORT_SIMD_X86
+    using ShellSortTemplate::Simd::Ops;
+    using ShellSortTemplate::Simd::Avx2;
+    using ShellSortTemplate::Simd::Avx512;
+
+    // Runs the network over `lanes` arrays at once. rows holds them
+    // transposed, element i of every array side by side in row i, so one
+    // comparator is a vector compare and two selects on rows i and j.
+    // Stamped out once per instruction set, like the vector gap pass.
+#define BATCHSORT_SIMD_NETWORK(NAME, TARGET)                                                            \
+    template<class Ops, bool Greater, class V>                                                          \
+    __attribute__((target(TARGET)))                                                                     \
+    void NAME(V *rows, const std::uint32_t *pairs, const std::size_t count) noexcept {                  \
+        constexpr std::size_t lanes = Ops::lanes;                                                       \
+                                                                                                        \
+        for (std::size_t k = 0; k < count; k++) {                                                       \
+            V *const a = rows + (pairs[k] >> 16) * lanes;                                               \
+            V *const b = rows + (pairs[k] & 0xffff) * lanes;                                            \
+            const auto x = Ops::load(a);                                                                \
+            const auto y = Ops::load(b);                                                                \
+            const auto swap = Greater ? Ops::lt(x, y) : Ops::lt(y, x);                                  \
+                                                                                                        \
+            Ops::store(a, Ops::select(swap, y, x));                                                     \
+            Ops::store(b, Ops::select(swap, x, y));                                                     \
+        }                                                                                               \
+    }
+
+    BATCHSORT_SIMD_NETWORK(network_avx2, "avx2")
+    BATCHSORT_SIMD_NETWORK(network_avx512, "avx512f")
+
+#undef BATCHSORT_SIMD_NETWORK
+
+    // Sorts the arrays of [first, first + count * length) in groups of
+    // Ops::lanes, transposed into rows and back; returns how many arrays it
+    // sorted, the rest are left to the caller.
+    template<class Ops, bool Greater, class V>
+    std::size_t sort_groups(V *first, const std::size_t count, const std::size_t length, const std::vector<std::uint32_t> &pairs, void (*network)(V *, const std::uint32_t *, std::size_t)) {
+        constexpr std::size_t lanes = Ops::lanes;
+        const std::size_t groups = count / lanes;
+        const auto rows = std::make_unique<V[]>(length * lanes);
+
+        for (std::size_t g = 0; g < groups; g++) {
+            V *const group = first + g * lanes * length;
+
+            for (std::size_t i = 0; i < length; i++)
+                for (std::size_t l = 0; l < lanes; l++)
+                    rows[i * lanes + l] = group[l * length + i];
+
+            network(rows.get(), pairs.data(), pairs.size());
+
+            for (std::size_t l = 0; l < lanes; l++)
+                for (std::size_t i = 0; i < length; i++)
+                    group[l * length + i] = rows[i * lanes + l];
+        }
+
+        return groups * lanes;
+    }
+#endif
+
+#ifdef SHELLSORT_SIMD_X86
+    // Sorts the groups of arrays the widest vectors of the CPU take and
+    // returns how many arrays that was; none when the schedule or the rows
+    // cannot be allocated, which leaves every array to the caller.
+    template<bool Greater, class V>
+    std::size_t sort_vectors(V *first, const std::size_t count, const std::size_t length) noexcept {
+        namespace Simd = ShellSortTemplate::Simd;
+        using Wide = Ops<Avx512, sizeof(V), Simd::kind<V>>;
+        using Narrow = Ops<Avx2, sizeof(V), Simd::kind<V>>;
+
+        std::size_t done = 0;
+
+        ShellSortTemplate::try_allocating([&] {
+            switch (Simd::cpu_level()) {
+                case Simd::Level::avx512:
+                    if (count >= Wide::lanes) {
+                        done = sort_groups<Wide, Greater>(first, count, length, schedule(length), &network_avx512<Wide, Greater, V>);
+                        break;
+                    }
+                    [[fallthrough]];
+                case Simd::Level::avx2:
+                    if (count >= Narrow::lanes)
+                        done = sort_groups<Narrow, Greater>(first, count, length, schedule(length), &network_avx2<Narrow, Greater, V>);
+                    break;
+                default:
+                    break;
+            }
+        });
+
+        return done;
+    }
+#endif
+
+    template<class Iterator, class Comparator>
+    constexpr bool supported = ShellSortTemplate::Simd::supported<ShellSortTemplate::unwrapped_t<Iterator>, Comparator>;
+
+    // Sorts every array of `length` elements in [first, last), which holds
+    // them back to back. Groups of 8 or 16 arrays of 32- or 64-bit numbers
+    // ordered by std::less or std::greater run one sorting network in the
+    // lanes of the widest vectors the CPU has; the arrays left over, and all
+    // arrays of other types, are shell sorted one by one with `Sequence`.
+    // Either way float and double follow the order of sort() under Policy:
+    // IEEE totalOrder with encode_keys, the comparator without.
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = ShellSortTemplate::DefaultPolicy>
+    void sort(Iterator first, Iterator last, const std::size_t length, Comparator comp = Comparator()) noexcept {
+        if (length < 2)
+            return;
+
+        const std::size_t count = std::size_t(std::distance(first, last)) / length;
+        std::size_t done = 0;
+
+#ifdef SHELLSORT_SIMD_X86
+        if constexpr (supported<Iterator, Comparator>) {
+            namespace Simd = ShellSortTemplate::Simd;
+            namespace Keys = ShellSortTemplate::Keys;
+            using V = std::remove_pointer_t<ShellSortTemplate::unwrapped_t<Iterator>>;
+            constexpr bool greater = Simd::direction<Comparator, V>::value == 2;
+
+            // a single array has no other to share the vectors with
+            if (length <= max_length && count > 1) {
+                V *const data = ShellSortTemplate::unwrap(first, last);
+
+                // the arrays shell sorted one by one follow IEEE totalOrder
+                // with encode_keys, so the vector groups sort the same keys
+                if constexpr (Simd::kind<V> == 2 && Policy::encode_keys) {
+                    auto *const keys = Keys::encode_range(data, count * length);
+
+                    done = sort_vectors<greater>(keys, count, length);
+                    Keys::decode_range<V>(keys, count * length);
+                } else {
+                    done = sort_vectors<greater>(data, count, length);
+                }
+            }
+        }
+#endif
+
+        for (std::size_t k = done; k < count; k++) {
+            const Iterator array = std::next(first, k * length);
+            ShellSortTemplate::sort<Iterator, Sequence, Comparator, Policy>(array, std::next(array, length), comp);
+        }
+    }
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, const std::size_t length, Comparator comp = Comparator()) noexcept {
+        sort<Iterator, FibFuzzyNS::Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, length, comp);
+    }
+
+};
+
+#endif
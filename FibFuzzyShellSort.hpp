@@ -1,70 +1,27 @@
 #ifndef FIBFUZZYSHELLSORT_HPP
 #define FIBFUZZYSHELLSORT_HPP
 
-#include <limits>
+#include <cstdint>
 #include "ShellSortTemplate.hpp"
-#include "IntegralConstantArithmetic.hpp"
+#include "GapTable.hpp"
 
 namespace FibFuzzyNS {
-    using namespace IntegralConstantArithmetic;
-
-    template <class Numeric, size_t sz> 
-    struct Number {
-        using fib_type = add_t<typename Number<Numeric, sz - 1>::fib_type, typename Number<Numeric, sz - 2>::fib_type>;
-        using grand_type = neg_t<typename Number<Numeric, sz - 1>::grand_type>;
-
-        using type = add_t<fib_type, grand_type>;
-    };
-
-    template <class Numeric>
-    struct Number<Numeric, 0> {
-        using type = IC<Numeric, 1>;
-    };
+    // Fibonacci numbers from 5, 8 plus alternately -1 and +1, after a leading 1;
+    // the adjustments of two neighbours cancel, so each gap is the sum of
+    // the two before it plus the next adjustment
+    inline constexpr std::intmax_t seeds[] = {1, 4, 9};
+    inline constexpr auto next = [](const auto &f) { return f(1) + f(2) + (f.size() % 2 ? -1 : 1); };
 
     template <class Numeric>
-    struct Number<Numeric, 1> {
-        using fib_type = IC<Numeric, 5>;
-        using grand_type = IC<Numeric, -1>;
-
-        using type = add_t<fib_type, grand_type>;
-    };
+    constexpr auto gaps = GapTable::table<Numeric, seeds, next>;
 
-    template <class Numeric>
-    struct Number<Numeric, 2> {
-        using fib_type = IC<Numeric, 8>;
-        using grand_type = IC<Numeric, 1>;
-
-        using type = add_t<fib_type, grand_type>;
-    };
-    
     template <class Numeric = int>
     class Sequence {
         // Fibonacci grand number generator
         //
-        
-        static constexpr size_t table_size() {
-            constexpr Numeric max_num = std::numeric_limits<Numeric>::max();
-            Numeric f0(5), f1(8), f2(1);
-            Numeric grand = -1;
-
-            size_t sz = 3;
-            while ((max_num - f1) >= (f0 + grand)) {
-                f2 = f1 + f0;
-                f0 = f1;
-                f1 = f2;
-                grand = - grand;
-                sz++;
-            }
-
-            return sz;
-        }
-        template <size_t ...I>
-        static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
-            return std::integer_sequence<Numeric, Number<Numeric, sizeof...(I) - I - 1>::type::value...>{};
-        }
 
         public:
-        using type = decltype(gen_seq(std::make_index_sequence<table_size()>())); 
+        using type = GapTable::sequence_t<gaps<Numeric>>;
     };
 
     template<class Iterator, class Comparator=std::less<>>
@@ -72,6 +29,11 @@ namespace FibFuzzyNS {
         ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
     }
 
+    template<class Iterator, class Comparator>
+    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp, threads);
+    }
+
 };
 
 #endif
@@ -10,289 +10,108 @@
 #include <cstdlib>
 #include <cassert>
 #include <type_traits>
+#include <thread>
+#include <string>
+#include <vector>
 
 #include "Fib13ShellSort.hpp"
 #include "A109110ShellSort.hpp"
 #include "TokudaShellSort.hpp"
 #include "FibFuzzyShellSort.hpp"
-
-namespace FibNS {
-    using namespace IntegralConstantArithmetic;
-    
-    template <class N, size_t sz>
-    struct Number {
-        using type = add_t<typename Number<N, sz - 1>::type, typename Number<N, sz - 2>::type>;
-    };
-
-    template <class N>
-    struct Number<N, 0> {
-        using type = IC<N, 1>;
-    };
-
-    template <class N>
-    struct Number<N, 1> {
-        using type = IC<N, 2>;
-    };
-    
-    template <class Numeric = int>
-    class Sequence {
-        // Fibonacci number generator
-        //
-        
-        static constexpr size_t table_size() {
-            constexpr Numeric max_num = std::numeric_limits<Numeric>::max();
-            Numeric f0(1), f1(2), f2(1);
-
-            size_t sz = 2;
-            while ((max_num - f1) >= f0) {
-                f2 = f1 + f0;
-                f0 = f1;
-                f1 = f2;
-                sz++;
-            }
-
-            return sz;
-        }
-        template <size_t ...I>
-        static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
-            return std::integer_sequence<Numeric, Number<Numeric, sizeof...(I) - I - 1>::type::value...>{};
-        }
-
-        public:
-        using type = decltype(gen_seq(std::make_index_sequence<table_size()>())); 
-    };
-
-    template<class Iterator, class Comparator=std::less<>>
-    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
-        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
-    }
+#include "FibShellSort.hpp"
+#include "SampleShellSort.hpp"
+#include "PrattShellSort.hpp"
+#include "RadixShellSort.hpp"
+#include "BatchShellSort.hpp"
+#include "GapRegistry.hpp"
+#include "AutoShellSort.hpp"
+#include "ResumableShellSort.hpp"
+#include "StreamShellSort.hpp"
+#include "Benchmark.hpp"
+
+// sweeps every gap pass row by row, to measure the cache blocking
+struct UnblockedPolicy : ShellSortTemplate::DefaultPolicy {
+    static constexpr std::size_t cache_block_bytes = 0;
 };
 
-namespace Benchmark {
-    using TimeUnit = std::chrono::duration<double, std::milli>;
-    using DeciSecond = std::chrono::duration<double, std::deci>;
-    using Second = std::chrono::duration<double>;
-
-    template<char ...ch>
-        struct TaskName {
-            static constexpr char name[sizeof...(ch) + 1] = {ch..., '\0'};
-        };
-
-#define tname(s) s##_tname
-
-    template <class T, T... chars>
-    constexpr TaskName<chars...> operator ""_tname() { return {}; }
-
-    template<class Name, class Func>
-        struct Task2 : Name, Func {
-            static int cycles;
-            static size_t size;
-            static double mean;
-            static double variance;
-            static double stddev;
-            static double relative_stddev;
-
-            static double average_count;
-
-            using of = Name;
-
-            template<class Init>
-                void run_warmup(TimeUnit warmup, Init &init) const {
-                    int count = 0;
-                    TimeUnit total(0);
-
-                    using self = typename std::remove_cv<std::remove_reference_t<decltype(*this)>>::type;
-                    constexpr auto cmp = [](const int &a, const int &b) constexpr ->bool { return a < b;};
-
-                    while (warmup.count() > 0) {
-                        init();
-
-                        auto before = std::chrono::high_resolution_clock::now();
-
-                        Func::operator()(cmp);
-
-                        auto after = std::chrono::high_resolution_clock::now();
-
-                        auto tmp = std::chrono::duration_cast<TimeUnit>(after - before);
-
-                        total += tmp;
-                        warmup -= tmp;
-                        count++;
-                    }
-
-                    self::cycles = std::max(1, int(count / std::chrono::duration_cast<DeciSecond>(total).count()));
-                }
-
-            template<class Init>
-                void run_calculate(TimeUnit calc_time, Init &init) const {
-                    using self = typename std::remove_cv<std::remove_reference_t<decltype(*this)>>::type;
-                    self::size = 0;
-                    size_t counter = 0;
-                    auto cmp = [&counter](const int &a, const int &b) ->bool { counter++; return a < b;};
-                    
-                    do {
-                        TimeUnit subtotal(0);
-                        counter = 0;
-
-                        for (int i = 0; i < self::cycles; i++) {
-                            init();
-
-                            auto before = std::chrono::high_resolution_clock::now();
-
-                            Func::operator()(cmp);
-
-                            auto after = std::chrono::high_resolution_clock::now();
-
-                            subtotal += std::chrono::duration_cast<TimeUnit>(after - before);
-                        }
-
-                        calc_time -= subtotal;
-
-                        auto count_n = (double)counter / self::cycles;
-                        auto measure_n = std::chrono::duration_cast<Second>(subtotal).count();
-                        self::size++;
-
-                        if (size > 1) {
-                            auto delta = measure_n - self::mean;
-                            self::mean += delta / self::size;
-                            auto delta2 = measure_n - self::mean;
-                            self::variance += delta * delta2;
-
-                            delta = count_n - self::average_count;
-                            self::average_count += delta / self::size;
-                        } else {
-                            self::mean = measure_n;
-                            self::average_count = count_n;
-                        }
-
-                    } while(calc_time.count() > 0);
-
-                    self::variance /= self::size;
-                    self::stddev = std::sqrt(self::variance);
-                    self::relative_stddev = 100.0 * (self::stddev / self::mean);
-                }
-
-            constexpr void clean() const {
-                using self = typename std::remove_cv<std::remove_reference_t<decltype(*this)>>::type;
-
-                self::cycles = 0;
-                self::size = 0;
-                self::mean = 0;
-                self::variance = 0;
-                self::stddev = 0;
-                self::relative_stddev = 0;
-                self::average_count = 0;
-            }
-
-        };
-    template<class Name, class Func>
-        int Task2<Name,Func>::cycles = 0;
-    template<class Name, class Func>
-        size_t Task2<Name,Func>::size = 0;
-    template<class Name, class Func>
-        double Task2<Name,Func>::mean = 0;
-    template<class Name, class Func>
-        double Task2<Name,Func>::variance = 0;
-    template<class Name, class Func>
-        double Task2<Name,Func>::stddev = 0;
-    template<class Name, class Func>
-        double Task2<Name,Func>::relative_stddev = 0;
-    template<class Name, class Func>
-        double Task2<Name,Func>::average_count = 0;
-
-    template<class Name, class Func>
-        Task2(Name, Func) -> Task2<Name, Func>;
-
-    template<class init_func, class ...task_func>
-        class IPS2 : init_func, task_func... {
-
-            template<size_t ...I>
-                constexpr void run(TimeUnit warmup, TimeUnit calc, bool is_tty, std::index_sequence<I...>) const {
-                    ((([&]() constexpr {
-                       const auto init = [this]() constexpr { init_func::operator()(); };
-                       task_func::clean();
-                       task_func::run_warmup(warmup, init);
-                       task_func::run_calculate(calc, init);
-                       report(I, is_tty, std::make_index_sequence<sizeof...(task_func)>());
-                       })()),...);
-                }
-
-            template <size_t ...I>
-                constexpr void report(size_t x, bool is_tty,std::index_sequence<I...>) const {
-                    auto ftsk = fast_task(x, std::make_index_sequence<sizeof...(task_func)>());
-                    auto stsk = slow_task(x, std::make_index_sequence<sizeof...(task_func)>());
-                    auto lntsk = longest_name_task(x, std::make_index_sequence<sizeof...(task_func)>());
-                    auto sz = snprintf(NULL, 0, "%5.2lf", (double)(ftsk) / stsk) - 3;
-
-                    if (is_tty && x)
-                        printf("\e[%zuA", x);
-
-
-                    (((I <= x) && 
-                      (([&]()constexpr ->bool{
-                        printf("%*s", (int)lntsk, task_func::of::name);
-                        auto m = task_func::mean;
-
-                        if (m < 1.e3)
-                        printf(" %6.2lf  (%6.2lfs )", task_func::mean, 1 / task_func::mean);
-                        else if (m < 1.e6)
-                        printf(" %6.2lfk (%6.2lfms)", task_func::mean / 1.e3, 1.e3 / task_func::mean);
-                        else if (m < 1.e9)
-                        printf(" %6.2lfM (%6.2lfus)", task_func::mean / 1.e6, 1.e6 / task_func::mean);
-                        else
-                        printf(" %6.2lfG (%6.2lfns)", task_func::mean / 1.e9, 1.e9 / task_func::mean);
-
-                        printf(" (±%5.2lf%%)", task_func::relative_stddev);
-
-                        printf(" cmp: %14.2lf", task_func::average_count);
-
-                        if (ftsk == task_func::size)
-                            printf(" %*s fastest\n", sz + 3, "");
-                        else
-                            printf(" %*.2lf× slower \n", sz, (double)ftsk / task_func::size);
+// sweeps pairs of consecutive gaps together
+struct FusedPolicy : ShellSortTemplate::DefaultPolicy {
+    static constexpr std::size_t fused_gaps = 2;
+};
 
-                        return true;
-                      })())) &&...);
+// heap sorts once a gap pass moves elements more than 16 times each on
+// average, counting how often that happens
+struct GuardedPolicy : ShellSortTemplate::DefaultPolicy {
+    static constexpr std::size_t guard_moves = 16;
+    static inline std::size_t runs = 0;
+    static inline std::size_t fallbacks = 0;
 
-                }
+    static void on_fallback(std::size_t) noexcept {
+        fallbacks++;
+    }
 
-            template <size_t...I>
-                constexpr size_t fast_task(size_t x, std::index_sequence<I...>) const {
-                    size_t sz = 0;
-                    (((I <= x) && (((sz < task_func::size) && (sz = task_func::size)) ||true)) &&...);
-                    return sz;
-                }
+    static void report() {
+        printf("guard fired in %zu of %zu guarded sorts\n", fallbacks, runs);
+        runs = fallbacks = 0;
+    }
+};
 
-            template <size_t...I>
-                constexpr size_t slow_task(size_t x, std::index_sequence<I...>) const {
-                    size_t sz = std::numeric_limits<size_t>::max();
+// compares whole strings at every step, to measure the prefix keys
+struct PlainStringPolicy : ShellSortTemplate::DefaultPolicy {
+    static constexpr bool string_prefix_keys = false;
+};
 
-                    (((I <= x) && (((sz > task_func::size) && (sz = task_func::size)) ||true)) &&...);
-                    return sz;
-                }
+constexpr size_t size = 10'000'000;
+std::array<int, size> arr;
 
-            template <size_t...I>
-                constexpr size_t longest_name_task(size_t x, std::index_sequence<I...>) const {
-                    size_t sz = 0;        
-                    (((I <= x) && (((sz < sizeof(task_func::of::name)) && (sz = sizeof(task_func::of::name))) ||true)) &&...);
-                    return sz;
-                }
-            public:
+constexpr size_t string_size = 1'000'000;
+constexpr size_t batch_length = 128;
+std::vector<std::string> strs, strs_input;
+std::vector<float> floats;
+
+// "2024-05-17 13:04:59.123 WARN  [db-pool] request 8812 took 193 ms"
+std::vector<std::string> log_lines(size_t n, std::mt19937 &gen) {
+    const char *levels[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+    const char *components[] = {"http", "db-pool", "auth", "cache", "scheduler", "mailer", "search", "billing"};
+    std::vector<std::string> lines;
+    char buf[160];
+
+    for (size_t i = 0; i < n; i++) {
+        const unsigned ms = gen() % 86'400'000;
+        snprintf(buf, sizeof(buf), "2024-05-17 %02u:%02u:%02u.%03u %s [%s] request %u took %u ms",
+                ms / 3'600'000, ms / 60'000 % 60, ms / 1000 % 60, ms % 1000,
+                levels[gen() % 4], components[gen() % 8], unsigned(gen() % 100000), unsigned(gen() % 2000));
+        lines.emplace_back(buf);
+    }
 
-            IPS2(init_func init, task_func...tasks) : init_func(init), task_func(tasks)... {}
+    return lines;
+}
 
-            constexpr void run(TimeUnit warmup, TimeUnit calc, bool is_tty = true) const {
-                run(warmup, calc, is_tty, std::make_index_sequence<sizeof...(task_func)>());
-            }
-        };
+// "https://shop.example.com/catalog/shoes/item?id=48213"
+std::vector<std::string> urls(size_t n, std::mt19937 &gen) {
+    const char *hosts[] = {"www.example.com", "shop.example.com", "api.example.com", "cdn.example.net",
+                           "blog.example.org", "docs.example.org", "m.example.com", "static.example.net"};
+    const char *words[] = {"catalog", "shoes", "item", "user", "profile", "search", "cart", "v1", "v2",
+                           "images", "assets", "posts", "2024", "tags", "help", "orders"};
+    std::vector<std::string> out;
+
+    for (size_t i = 0; i < n; i++) {
+        std::string url = gen() % 4 ? "https://" : "http://";
+        url += hosts[gen() % 8];
+
+        for (unsigned d = 1 + gen() % 4; d > 0; d--) {
+            url += '/';
+            url += words[gen() % 16];
+        }
 
-    template <class init_func, class ...task_func>
-        IPS2(init_func, task_func...) -> IPS2<init_func, task_func...>;
+        if (gen() % 2)
+            url += "?id=" + std::to_string(gen() % 1'000'000);
 
-};
+        out.push_back(std::move(url));
+    }
 
-constexpr size_t size = 10'000'000;
-std::array<int, size> arr;
+    return out;
+}
 
 int main() {
     using namespace std::chrono_literals;
@@ -321,6 +140,94 @@ int main() {
                         FibFuzzyNS::shellsort(arr.begin(), arr.end(), cmp);
                     }
                 },
+                Task2 {
+                    tname("fib shell sort (guarded)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        GuardedPolicy::runs++;
+                        ShellSortTemplate::sort<Iterator, FibNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, GuardedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("radix shell sort"),
+                    [](auto&) {
+                        // the partition needs std::less<>, so no comparisons are counted
+                        RadixSortNS::shellsort(arr.begin(), arr.end());
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (runtime gaps)"),
+                    [](auto& cmp) {
+                        ShellSortTemplate::sort(arr.begin(), arr.end(), *GapRegistry::find("fib-fuzzy"), cmp);
+                    }
+                },
+                Task2 {
+                    tname("auto shell sort"),
+                    [](auto& cmp) {
+                        AutoSortNS::shellsort(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (resumable)"),
+                    [](auto& cmp) {
+                        // in 1ms installments, as an event loop would run it
+                        auto sorter = ResumableSortNS::sorter(arr.begin(), arr.end(), cmp);
+                        while (!sorter.run_for(std::chrono::milliseconds(1))) {}
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (stream)"),
+                    [](auto& cmp) {
+                        // appended in batches of 4096, read back in order
+                        using Value = std::remove_reference_t<decltype(arr[0])>;
+                        StreamSortNS::Buffer<Value, FibFuzzyNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>> buffer(cmp);
+                        buffer.reserve(arr.size());
+                        for (std::size_t i = 0; i < arr.size(); i += 4096)
+                            buffer.append(arr.begin() + i, arr.begin() + std::min(arr.size(), i + 4096));
+                        const auto view = buffer.sorted();
+                        std::copy(view.begin(), view.end(), arr.begin());
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (unblocked)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        ShellSortTemplate::sort<Iterator, FibFuzzyNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, UnblockedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (fused)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        ShellSortTemplate::sort<Iterator, FibFuzzyNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, FusedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (simd)"),
+                    [](auto&) {
+                        // std::less<> is what selects the vector gap pass
+                        FibFuzzyNS::shellsort(arr.begin(), arr.end(), std::less<>());
+                    }
+                },
+                Task2 {
+                    tname("pratt shell sort"),
+                    [](auto& cmp) {
+                        PrattNS::shellsort(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("pratt shell sort (vectorized)"),
+                    [](auto&) {
+                        PrattNS::shellsort(arr.begin(), arr.end(), std::less<>());
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (threads)"),
+                    [](auto&) {
+                        // the counting comparator is not thread safe
+                        FibFuzzyNS::shellsort(arr.begin(), arr.end(), std::less<>(), 0);
+                    }
+                },
                 Task2 {
                     tname("std sort"),
                     [](auto& cmp) {
@@ -346,6 +253,7 @@ int main() {
         };
 
         ips.run(2s, 5s);
+        GuardedPolicy::report();
 
     }
 
@@ -370,6 +278,14 @@ int main() {
                         FibFuzzyNS::shellsort(arr.begin(), arr.end(), cmp);
                     }
                 },
+                Task2 {
+                    tname("fib shell sort (guarded)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        GuardedPolicy::runs++;
+                        ShellSortTemplate::sort<Iterator, FibNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, GuardedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
                 Task2 {
                     tname("std sort"),
                     [](auto& cmp) {
@@ -395,6 +311,7 @@ int main() {
         };
 
         ips.run(2s, 5s);
+        GuardedPolicy::report();
     }
 
     {
@@ -418,6 +335,14 @@ int main() {
                         FibFuzzyNS::shellsort(arr.begin(), arr.end(), cmp);
                     }
                 },
+                Task2 {
+                    tname("fib shell sort (guarded)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        GuardedPolicy::runs++;
+                        ShellSortTemplate::sort<Iterator, FibNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, GuardedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
                 Task2 {
                     tname("std sort"),
                     [](auto& cmp) {
@@ -444,6 +369,7 @@ int main() {
         };
 
         ips.run(2s, 5s);
+        GuardedPolicy::report();
     }
 
     {
@@ -474,6 +400,21 @@ int main() {
                         FibFuzzyNS::shellsort(arr.begin(), arr.end(), cmp);
                     }
                 },
+                Task2 {
+                    tname("fib shell sort (guarded)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        GuardedPolicy::runs++;
+                        ShellSortTemplate::sort<Iterator, FibNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, GuardedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("radix shell sort"),
+                    [](auto&) {
+                        // the partition needs std::less<>, so no comparisons are counted
+                        RadixSortNS::shellsort(arr.begin(), arr.end());
+                    }
+                },
                 Task2 {
                     tname("std sort"),
                     [](auto& cmp) {
@@ -500,6 +441,7 @@ int main() {
         };
 
         ips.run(2s, 5s);
+        GuardedPolicy::report();
     }
 
     {
@@ -530,6 +472,21 @@ int main() {
                         FibFuzzyNS::shellsort(arr.begin(), arr.end(), cmp);
                     }
                 },
+                Task2 {
+                    tname("fib shell sort (guarded)"),
+                    [](auto& cmp) {
+                        using Iterator = decltype(arr.begin());
+                        GuardedPolicy::runs++;
+                        ShellSortTemplate::sort<Iterator, FibNS::Sequence<std::ptrdiff_t>, std::remove_reference_t<decltype(cmp)>, GuardedPolicy>(arr.begin(), arr.end(), cmp);
+                    }
+                },
+                Task2 {
+                    tname("radix shell sort"),
+                    [](auto&) {
+                        // the partition needs std::less<>, so no comparisons are counted
+                        RadixSortNS::shellsort(arr.begin(), arr.end());
+                    }
+                },
                 Task2 {
                     tname("std sort"),
                     [](auto& cmp) {
@@ -556,6 +513,160 @@ int main() {
         };
 
         ips.run(2s, 5s);
+        GuardedPolicy::report();
+    }
+
+    {
+        using namespace Benchmark;
+
+        printf("\nrandom float array with the size %zu\n", size);
+        floats.resize(size);
+
+        // std::less<> sorts the floats as order-preserving unsigned keys; the
+        // counting comparator is for int, so no comparisons are counted
+        IPS2 ips {
+            [&gen]() {
+                std::normal_distribution<float> dist(0, 1000);
+                std::generate(floats.begin(), floats.end(), [&]() { return dist(gen); });
+            },
+                Task2 {
+                    tname("fib fuzzy shell sort"),
+                    [](auto&) {
+                        FibFuzzyNS::shellsort(floats.begin(), floats.end());
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (comparator)"),
+                    [](auto&) {
+                        FibFuzzyNS::shellsort(floats.begin(), floats.end(), [](float a, float b) { return a < b; });
+                    }
+                },
+                Task2 {
+                    tname("std sort"),
+                    [](auto&) {
+                        std::sort(floats.begin(), floats.end());
+                    }
+                }
+        };
+
+        ips.run(2s, 5s);
+    }
+
+    {
+        using namespace Benchmark;
+
+        // the arr integers as 10M / batch_length arrays of batch_length
+        printf("\n%zu random integer arrays with the size %zu\n", size / batch_length, batch_length);
+
+        IPS2 ips {
+            [&gen]() {
+                std::uniform_int_distribution<int> dist;
+                std::generate(arr.begin(), arr.end(), [&]() { return dist(gen); });
+            },
+                Task2 {
+                    tname("batch shell sort"),
+                    [](auto&) {
+                        BatchSortNS::shellsort(arr.begin(), arr.end(), batch_length);
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (one by one)"),
+                    [](auto&) {
+                        for (size_t k = 0; k + batch_length <= size; k += batch_length)
+                            FibFuzzyNS::shellsort(arr.begin() + k, arr.begin() + k + batch_length);
+                    }
+                },
+                Task2 {
+                    tname("std sort (one by one)"),
+                    [](auto&) {
+                        for (size_t k = 0; k + batch_length <= size; k += batch_length)
+                            std::sort(arr.begin() + k, arr.begin() + k + batch_length);
+                    }
+                }
+        };
+
+        ips.run(2s, 5s);
+    }
+
+    {
+        using namespace Benchmark;
+
+        for (auto make : {log_lines, urls}) {
+            strs_input = make(string_size, gen);
+            printf("\n%s with the size %zu\n", make == log_lines ? "log lines" : "urls", string_size);
+
+            // std::string is compared with std::less<>, which the prefix
+            // keys need, so no comparisons are counted
+            IPS2 ips {
+                []() {
+                    strs = strs_input;
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort"),
+                    [](auto&) {
+                        FibFuzzyNS::shellsort(strs.begin(), strs.end());
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (no prefix keys)"),
+                    [](auto&) {
+                        using Iterator = decltype(strs.begin());
+                        ShellSortTemplate::sort<Iterator, FibFuzzyNS::Sequence<std::ptrdiff_t>, std::less<>, PlainStringPolicy>(strs.begin(), strs.end());
+                    }
+                },
+                Task2 {
+                    tname("std sort"),
+                    [](auto&) {
+                        std::sort(strs.begin(), strs.end());
+                    }
+                }
+            };
+
+            ips.run(2s, 5s);
+        }
+    }
+
+    {
+        printf("\nthread scaling on random integer array with the size %zu\n", size);
+        using namespace Benchmark;
+
+        const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned t = 1; ; t = std::min(t * 2, max_threads)) {
+            printf("threads %u\n", t);
+
+            // the counting comparator is not thread safe, so all sorts,
+            // std::sort included, run with std::less<> and report no
+            // comparisons
+            IPS2 ips {
+                [&gen]() {
+                    std::generate(arr.begin(), arr.end(), gen);
+                },
+                Task2 {
+                    tname("sample shell sort"),
+                    [&t](auto&) {
+                        SampleSortNS::shellsort(arr.begin(), arr.end(), std::less<>(), t);
+                    }
+                },
+                Task2 {
+                    tname("fib fuzzy shell sort (threads)"),
+                    [&t](auto&) {
+                        FibFuzzyNS::shellsort(arr.begin(), arr.end(), std::less<>(), t);
+                    }
+                },
+                Task2 {
+                    tname("std sort"),
+                    [](auto&) {
+                        std::sort(arr.begin(), arr.end(), std::less<>());
+                    }
+                }
+            };
+
+            ips.run(2s, 5s);
+
+            if (t == max_threads)
+                break;
+        }
     }
 #else
     {
@@ -0,0 +1,36 @@
+#ifndef FIBSHELLSORT_HPP
+#define FIBSHELLSORT_HPP
+
+#include <cstdint>
+#include "ShellSortTemplate.hpp"
+#include "GapTable.hpp"
+
+namespace FibNS {
+    // F(n) = F(n - 1) + F(n - 2)
+    inline constexpr std::intmax_t seeds[] = {1, 2};
+    inline constexpr auto next = [](const auto &f) { return f(1) + f(2); };
+
+    template <class Numeric>
+    constexpr auto gaps = GapTable::table<Numeric, seeds, next>;
+
+    template <class Numeric = int>
+    class Sequence {
+        // Fibonacci number generator
+        //
+
+        public:
+        using type = GapTable::sequence_t<gaps<Numeric>>;
+    };
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
+    }
+
+    template<class Iterator, class Comparator>
+    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp, threads);
+    }
+};
+
+#endif
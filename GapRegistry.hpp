@@ -0,0 +1,63 @@
+#ifndef GAPREGISTRY_HPP
+#define GAPREGISTRY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include "ShellSortTemplate.hpp"
+#include "FibShellSort.hpp"
+#include "FibFuzzyShellSort.hpp"
+#include "Fib12ShellSort.hpp"
+#include "Fib13ShellSort.hpp"
+#include "TokudaShellSort.hpp"
+#include "A109110ShellSort.hpp"
+#include "Hib63ShellSort.hpp"
+#include "PS65ShellSort.hpp"
+
+namespace GapRegistry {
+    // The gaps of a compile-time sequence as a table, generated in 64-bit
+    // signed arithmetic like the sequences' own 64-bit instantiations.
+    template<class T, T ...Seq>
+    constexpr std::array<std::size_t, sizeof...(Seq)> table(std::integer_sequence<T, Seq...>) {
+        return {{std::size_t(Seq)...}};
+    }
+
+    template<template<class> class Sequence>
+    constexpr auto gaps = table(typename Sequence<std::int64_t>::type{});
+
+    template<template<class> class Sequence>
+    constexpr ShellSortTemplate::Gaps entry() {
+        return {gaps<Sequence>.data(), gaps<Sequence>.size()};
+    }
+
+    struct Entry {
+        std::string_view name;
+        ShellSortTemplate::Gaps gaps;
+    };
+
+    inline constexpr std::array<Entry, 8> sequences = {{
+        {"fib", entry<FibNS::Sequence>()},
+        {"fib-fuzzy", entry<FibFuzzyNS::Sequence>()},
+        {"fib12", entry<Fib12NS::Sequence>()},
+        {"fib13", entry<Fib13NS::Sequence>()},
+        {"tokuda", entry<TokudaNS::Sequence>()},
+        {"a109110", entry<A109110NS::Sequence>()},
+        {"hib63", entry<Hib63NS::Sequence>()},
+        {"ps65", entry<PS65NS::Sequence>()},
+    }};
+
+    // The sequence registered under `name`, or nullptr.
+    constexpr const ShellSortTemplate::Gaps *find(const std::string_view name) noexcept {
+        for (const auto &e : sequences) {
+            if (e.name == name)
+                return &e.gaps;
+        }
+
+        return nullptr;
+    }
+
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef GAPTABLE_HPP
+#define GAPTABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace GapTable {
+    // Range of an index type: std::numeric_limits by default. Specialise it
+    // for index types of your own.
+    template<class Numeric>
+    struct limits {
+        static constexpr Numeric min() noexcept { return std::numeric_limits<Numeric>::min(); }
+        static constexpr Numeric max() noexcept { return std::numeric_limits<Numeric>::max(); }
+    };
+
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef __int128 int128;
+    __extension__ typedef unsigned __int128 uint128;
+
+    // Not every standard library fills in std::numeric_limits of the 128-bit
+    // types in strict ISO modes.
+    template<>
+    struct limits<int128> {
+        static constexpr int128 max() noexcept { return int128(~uint128(0) >> 1); }
+        static constexpr int128 min() noexcept { return -max() - 1; }
+    };
+
+    template<>
+    struct limits<uint128> {
+        static constexpr uint128 min() noexcept { return 0; }
+        static constexpr uint128 max() noexcept { return ~uint128(0); }
+    };
+#endif
+
+    // A number that remembers whether any operation that produced it left
+    // the range of Numeric. The result of such an operation is meaningless,
+    // but never computed by overflowing arithmetic.
+    template<class Numeric>
+    struct Checked {
+        Numeric value{};
+        bool overflow = false;
+
+        constexpr Checked() noexcept = default;
+
+        template<class V>
+        constexpr Checked(const V v, const bool overflow = false) noexcept : value(Numeric(v)), overflow(overflow) {}
+
+        // v in Numeric, flagged when it is out of range. It is built up bit
+        // by bit through the checked operators, from v / 2^k down to v, so
+        // an index type of your own needs no conversion back to V.
+        template<class V>
+        static constexpr Checked of(const V v) noexcept {
+            Checked n(0);
+
+            for (int k = std::numeric_limits<V>::digits - 1; k >= 0; k--) {
+                const V r = v / (V(1) << k) % 2;
+
+                n = n * Checked(2) + Checked(r > 0 ? 1 : 0) - Checked(r < 0 ? 1 : 0);
+            }
+
+            return n;
+        }
+
+        friend constexpr Checked operator+(const Checked a, const Checked b) noexcept {
+            const Numeric zero(0);
+            const bool over = (zero < b.value && limits<Numeric>::max() - b.value < a.value) ||
+                              (b.value < zero && a.value < limits<Numeric>::min() - b.value);
+
+            return {over ? a.value : a.value + b.value, over || a.overflow || b.overflow};
+        }
+
+        friend constexpr Checked operator-(const Checked a, const Checked b) noexcept {
+            const Numeric zero(0);
+            const bool over = (zero < b.value && a.value < limits<Numeric>::min() + b.value) ||
+                              (b.value < zero && limits<Numeric>::max() + b.value < a.value);
+
+            return {over ? a.value : a.value - b.value, over || a.overflow || b.overflow};
+        }
+
+        friend constexpr Checked operator-(const Checked a) noexcept {
+            return Checked(0) - a;
+        }
+
+        friend constexpr Checked operator*(const Checked a, const Checked b) noexcept {
+            const Numeric zero(0);
+            constexpr Numeric min = limits<Numeric>::min(), max = limits<Numeric>::max();
+            bool over = false;
+
+            if (zero < a.value)
+                over = zero < b.value ? max / b.value < a.value : b.value < min / a.value;
+            else if (a.value < zero)
+                over = zero < b.value ? a.value < min / b.value : b.value < zero && a.value < max / b.value;
+
+            return {over ? a.value : a.value * b.value, over || a.overflow || b.overflow};
+        }
+
+        friend constexpr Checked operator/(const Checked a, const Checked b) noexcept {
+            const bool over = b.value == Numeric(0) ||
+                              (limits<Numeric>::min() < Numeric(0) && a.value == limits<Numeric>::min() && b.value == Numeric(-1));
+
+            return {over ? a.value : a.value / b.value, over || a.overflow || b.overflow};
+        }
+
+        friend constexpr Checked operator%(const Checked a, const Checked b) noexcept {
+            const bool over = b.value == Numeric(0) ||
+                              (limits<Numeric>::min() < Numeric(0) && a.value == limits<Numeric>::min() && b.value == Numeric(-1));
+
+            return {over ? a.value : a.value % b.value, over || a.overflow || b.overflow};
+        }
+    };
+
+    // How far back a recurrence can look.
+    constexpr std::size_t window = 4;
+
+    // The terms generated so far, as a recurrence sees them: f(1) is the
+    // latest, f(2) the one before it, and so on up to f(window); f.size()
+    // counts all of them.
+    template<class Numeric>
+    class Terms {
+        Checked<Numeric> last[window]{};
+        std::size_t count = 0;
+
+        public:
+        constexpr Checked<Numeric> operator()(const std::size_t k) const noexcept {
+            return last[(count - k) % window];
+        }
+
+        constexpr std::size_t size() const noexcept {
+            return count;
+        }
+
+        constexpr void push(const Numeric v) noexcept {
+            last[count % window] = v;
+            count++;
+        }
+    };
+
+    template<class Numeric, const auto &Seeds>
+    constexpr bool seeds_fit() noexcept {
+        for (const auto s : Seeds) {
+            if (Checked<Numeric>::of(s).overflow)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Walks the sequence that starts with the Seeds and continues with
+    // Next(f), handing every term to emit, until a term overflows Numeric or
+    // fails to exceed the one before it. Returns the number of terms. Seeds
+    // that do not fit Numeric do not compile.
+    template<class Numeric, const auto &Seeds, const auto &Next, class Emit>
+    constexpr std::size_t walk(Emit emit) noexcept {
+        static_assert(seeds_fit<Numeric, Seeds>(), "a seed of the gap table does not fit its index type");
+
+        Terms<Numeric> f;
+
+        for (const auto s : Seeds) {
+            const Numeric n = Checked<Numeric>::of(s).value;
+
+            f.push(n);
+            emit(n);
+        }
+
+        for (;;) {
+            const Checked<Numeric> n = Next(f);
+
+            if (n.overflow || !(f(1).value < n.value))
+                break;
+
+            f.push(n.value);
+            emit(n.value);
+        }
+
+        return f.size();
+    }
+
+    template<class Numeric, const auto &Seeds, const auto &Next>
+    constexpr std::size_t size() noexcept {
+        return walk<Numeric, Seeds, Next>([](Numeric) {});
+    }
+
+    // The terms in descending order, as the gap passes take them.
+    template<class Numeric, const auto &Seeds, const auto &Next>
+    constexpr std::array<Numeric, size<Numeric, Seeds, Next>()> generate() noexcept {
+        constexpr std::size_t sz = size<Numeric, Seeds, Next>();
+        std::array<Numeric, sz> desc{};
+        std::size_t k = sz;
+
+        walk<Numeric, Seeds, Next>([&desc, &k](const Numeric v) { desc[--k] = v; });
+
+        return desc;
+    }
+
+    template<class Numeric, const auto &Seeds, const auto &Next>
+    inline constexpr auto table = generate<Numeric, Seeds, Next>();
+
+    template<const auto &Table, std::size_t ...I>
+    constexpr auto sequence(std::index_sequence<I...>) noexcept {
+        return std::integer_sequence<typename std::decay_t<decltype(Table)>::value_type, Table[I]...>{};
+    }
+
+    // The table as the Sequence<Numeric>::type of the compile-time sort.
+    template<const auto &Table>
+    using sequence_t = decltype(sequence<Table>(std::make_index_sequence<Table.size()>()));
+};
+
+#endif
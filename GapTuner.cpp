@@ -0,0 +1,404 @@
+// Offline search for a gap sequence tuned to one element type, size band and
+// input distribution. Candidates are timed and their comparisons counted by
+// the Benchmark::Task2 harness, and the winner is written out as a sequence
+// header like the shipped ones:
+//
+//   g++ -std=c++17 -O3 -pthread GapTuner.cpp -o GapTuner
+//   ./GapTuner --type int64 --min 1000 --max 100000 --input cubic --name Cubic64 > Cubic64ShellSort.hpp
+//
+// Options: --type int|int64|double|string, --min/--max size band, --input
+// random|cubic|dups|nearly, --objective comparisons|time (comparisons are
+// exact, time is only worth tuning on a quiet machine), --less (sort with
+// std::less<> instead of the counting comparator, which lets integer keys
+// take the vector kernels; implies --objective time, and is implied by
+// --type string), --mutations N, --calc MS (measuring time per candidate
+// and size), --seed N, --name NAME.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "GapRegistry.hpp"
+
+namespace Tuner {
+    struct Options {
+        std::string type = "int";
+        std::string input = "random";
+        std::string objective = "comparisons";
+        std::string name = "Tuned";
+        std::size_t min_size = 1 << 10;
+        std::size_t max_size = 1 << 20;
+        unsigned mutations = 64;
+        double calc_ms = 100;
+        unsigned seed = 1;
+        bool less = false;
+    };
+
+    // Ratios of the generated candidates and of the extension past the
+    // tuned gaps are multiples of 1 / ratio_den.
+    constexpr std::size_t ratio_den = 20;
+
+    struct Candidate {
+        std::vector<std::size_t> gaps;  // ascending, from 1 up to the largest size of the band
+        std::string origin;
+        double score = 0;
+        double comparisons = 0;
+        double ms = 0;
+    };
+
+    // 1, then floor(h * num / ratio_den) + 1 while below `limit`.
+    inline std::vector<std::size_t> ratio_gaps(const std::size_t num, const std::size_t limit) {
+        std::vector<std::size_t> gaps{1};
+
+        while (gaps.back() < limit)
+            gaps.push_back(gaps.back() * num / ratio_den + 1);
+
+        gaps.pop_back();
+        return gaps;
+    }
+
+    // Numerator of the ratio the emitted sequence grows by past the tuned
+    // gaps: that of its last two gaps, at least 3/2.
+    inline std::size_t extension_ratio(const std::vector<std::size_t> &gaps) {
+        if (gaps.size() < 2)
+            return ratio_den * 9 / 4;
+
+        const double r = double(gaps.back()) / double(gaps[gaps.size() - 2]);
+        return std::max(ratio_den * 3 / 2, std::size_t(std::lround(r * ratio_den)));
+    }
+
+    template<class V>
+    V element(std::mt19937_64 &gen, const std::int64_t key) {
+        if constexpr (std::is_same_v<V, std::string>) {
+            // fixed-width decimal keys with a shared prefix, like ids
+            char buf[32];
+            snprintf(buf, sizeof(buf), "id-%019lld", static_cast<long long>(key));
+            (void)gen;
+            return buf;
+        } else {
+            (void)gen;
+            return V(key);
+        }
+    }
+
+    template<class V>
+    std::vector<V> make_input(const Options &opt, const std::size_t n, std::mt19937_64 &gen) {
+        std::vector<std::int64_t> keys(n);
+
+        if (opt.input == "cubic") {
+            for (std::size_t i = 0; i < n; i++) {
+                const double x = 2.0 * double(i) / double(n) - 1.0;
+                keys[i] = std::int64_t((x * x * x + 1.0) / 2.0 * double(n) + 1);
+            }
+
+            std::shuffle(keys.begin(), keys.end(), gen);
+        } else if (opt.input == "dups") {
+            for (auto &k : keys)
+                k = std::int64_t(gen() % 16);
+        } else if (opt.input == "nearly") {
+            for (std::size_t i = 0; i < n; i++)
+                keys[i] = std::int64_t(i);
+
+            for (std::size_t s = 0; s < n / 100 + 1; s++)
+                std::swap(keys[gen() % n], keys[gen() % n]);
+        } else {
+            for (auto &k : keys)
+                k = std::int64_t(gen() >> 33);
+        }
+
+        std::vector<V> data;
+        data.reserve(n);
+
+        for (const auto k : keys)
+            data.push_back(element<V>(gen, k));
+
+        return data;
+    }
+
+    // Scores candidates on the smallest, the middle and the largest size of
+    // the band: the sum over the sizes of the comparisons, or nanoseconds,
+    // per element of one sort.
+    template<class V>
+    class Evaluator {
+        const Options &opt;
+        std::vector<std::vector<V>> inputs;
+        std::vector<V> work;
+        std::vector<std::size_t> table;
+
+        public:
+        Evaluator(const Options &opt) : opt(opt) {
+            std::mt19937_64 gen(opt.seed);
+            const std::size_t mid = std::size_t(std::sqrt(double(opt.min_size) * double(opt.max_size)));
+
+            for (const std::size_t n : {opt.min_size, mid, opt.max_size})
+                inputs.push_back(make_input<V>(opt, n, gen));
+        }
+
+        void score(Candidate &c) {
+            using namespace Benchmark;
+
+            table.assign(c.gaps.rbegin(), c.gaps.rend());
+            c.score = c.comparisons = c.ms = 0;
+
+            for (const auto &input : inputs) {
+                const ShellSortTemplate::Gaps gaps{table.data(), table.size()};
+                const auto init = [this, &input]() { work = input; };
+
+                Task2 task {
+                    tname("candidate"),
+                    [this, gaps](auto &cmp) {
+                        if (opt.less)
+                            ShellSortTemplate::sort(work.begin(), work.end(), gaps, std::less<>());
+                        else
+                            ShellSortTemplate::sort(work.begin(), work.end(), gaps, cmp);
+                    }
+                };
+
+                using Task = decltype(task);
+
+                task.clean();
+                task.run_warmup(TimeUnit(opt.calc_ms / 4), init);
+                task.run_calculate(TimeUnit(opt.calc_ms), init);
+
+                const double n = double(input.size());
+                const double ms = Task::mean / Task::cycles * 1e3;
+
+                c.comparisons += Task::average_count / n;
+                c.ms += ms;
+                c.score += opt.objective == "time" ? ms * 1e6 / n : Task::average_count / n;
+            }
+        }
+    };
+
+    // Moves one gap by up to 15%, drops one or splits one interval; the
+    // gaps stay strictly ascending from 1.
+    inline std::vector<std::size_t> mutate(std::vector<std::size_t> gaps, std::mt19937_64 &gen) {
+        std::uniform_real_distribution<double> factor(0.85, 1.15);
+        const std::size_t k = 1 + gen() % std::max<std::size_t>(1, gaps.size() - 1);
+
+        switch (gen() % 4) {
+            case 0:
+                if (k < gaps.size() && gaps.size() > 2) {
+                    gaps.erase(gaps.begin() + k);
+                    break;
+                }
+                [[fallthrough]];
+            case 1:
+                if (k < gaps.size() && gaps[k] - gaps[k - 1] > 2) {
+                    gaps.insert(gaps.begin() + k, std::size_t(std::sqrt(double(gaps[k]) * double(gaps[k - 1]))));
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                if (k < gaps.size())
+                    gaps[k] = std::max<std::size_t>(2, std::size_t(std::lround(double(gaps[k]) * factor(gen))));
+                break;
+        }
+
+        std::sort(gaps.begin(), gaps.end());
+        gaps.erase(std::unique(gaps.begin(), gaps.end()), gaps.end());
+        return gaps;
+    }
+
+    inline std::string upper(std::string s) {
+        for (auto &ch : s)
+            ch = char(std::toupper(static_cast<unsigned char>(ch)));
+        return s;
+    }
+
+    // Writes the winner as a <name>ShellSort.hpp header: the tuned gaps as
+    // the seeds of a GapTable recurrence that continues with the extension
+    // ratio.
+    inline void emit(const Options &opt, const Candidate &best, std::FILE *out) {
+        const std::string ns = opt.name + "NS";
+        const std::string guard = upper(opt.name) + "SHELLSORT_HPP";
+        const std::size_t num = extension_ratio(best.gaps);
+        const auto &g = best.gaps;
+
+        std::fprintf(out, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+        std::fprintf(out, "#include <cstdint>\n#include \"ShellSortTemplate.hpp\"\n#include \"GapTable.hpp\"\n\n");
+        std::fprintf(out, "namespace %s {\n", ns.c_str());
+
+        std::fprintf(out, "    // The tuned gaps, then h(n) = h(n - 1) * %zu / %zu + 1\n", num, ratio_den);
+        std::fprintf(out, "    inline constexpr std::intmax_t seeds[] = {");
+        for (std::size_t k = 0; k < g.size(); k++)
+            std::fprintf(out, "%s%zu", k ? ", " : "", g[k]);
+        std::fprintf(out, "};\n");
+        std::fprintf(out, "    inline constexpr auto next = [](const auto &f) { return f(1) * %zu / %zu + 1; };\n\n", num, ratio_den);
+
+        std::fprintf(out, "    template <class Numeric>\n    constexpr auto gaps = GapTable::table<Numeric, seeds, next>;\n\n");
+        std::fprintf(out, "    template <class Numeric = int>\n    class Sequence {\n");
+        std::fprintf(out, "        // Tuned by GapTuner for %s, %zu to %zu elements, %s input%s:\n",
+                     opt.type.c_str(), opt.min_size, opt.max_size, opt.input.c_str(), opt.less ? ", std::less" : "");
+        std::fprintf(out, "        // %.2f comparisons and %.3f ms over the band, from %s\n", best.comparisons, best.ms, best.origin.c_str());
+        std::fprintf(out, "        //\n\n");
+        std::fprintf(out, "        public:\n");
+        std::fprintf(out, "        using type = GapTable::sequence_t<gaps<Numeric>>;\n    };\n\n");
+
+        for (const bool threaded : {false, true}) {
+            if (threaded)
+                std::fprintf(out, "    template<class Iterator, class Comparator>\n    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {\n");
+            else
+                std::fprintf(out, "    template<class Iterator, class Comparator=std::less<>>\n    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {\n");
+
+            std::fprintf(out, "        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp%s);\n    }\n\n",
+                         threaded ? ", threads" : "");
+        }
+
+        std::fprintf(out, "};\n\n#endif\n");
+    }
+
+    // One line per candidate on stderr; * marks a new best.
+    inline void report(const Candidate &c, const bool better) {
+        std::fprintf(stderr, "%-32s cmp/elem %7.2f  %9.3f ms%s\n", c.origin.c_str(), c.comparisons, c.ms, better ? "  *" : "");
+    }
+
+    template<class V>
+    Candidate tune(const Options &opt) {
+        Evaluator<V> eval(opt);
+        std::mt19937_64 gen(opt.seed);
+        Candidate best;
+        best.score = HUGE_VAL;
+
+        const auto consider = [&](Candidate c) {
+            eval.score(c);
+            report(c, c.score < best.score);
+
+            if (c.score < best.score)
+                best = std::move(c);
+        };
+
+        // the shipped sequences, cut to the band
+        for (const auto &e : GapRegistry::sequences) {
+            Candidate c;
+            c.origin = std::string(e.name);
+
+            for (std::size_t k = e.gaps.count; k-- > 0;) {
+                if (e.gaps.first[k] < opt.max_size)
+                    c.gaps.push_back(e.gaps.first[k]);
+            }
+
+            if (c.gaps.empty() || c.gaps[0] != 1)
+                c.gaps.insert(c.gaps.begin(), 1);
+
+            consider(std::move(c));
+        }
+
+        // geometric sweep, ratios 1.70 to 3.20
+        for (std::size_t num = 34; num <= 64; num++) {
+            char origin[32];
+            snprintf(origin, sizeof(origin), "ratio %.2f", double(num) / ratio_den);
+            consider({ratio_gaps(num, opt.max_size), origin});
+        }
+
+        // hill climbing from the best; time scores need a 1% margin to
+        // move, or the search would chase noise
+        const double margin = opt.objective == "comparisons" ? 1.0 : 0.99;
+
+        const std::string root = best.origin;
+        unsigned accepted = 0;
+
+        for (unsigned m = 0; m < opt.mutations; m++) {
+            Candidate c{mutate(best.gaps, gen), root + ", " + std::to_string(accepted + 1) + " mutations"};
+
+            if (c.gaps == best.gaps)
+                continue;
+
+            eval.score(c);
+            report(c, c.score < best.score * margin);
+
+            if (c.score < best.score * margin) {
+                best = std::move(c);
+                accepted++;
+            }
+        }
+
+        return best;
+    }
+}
+
+int main(int argc, char **argv) {
+    Tuner::Options opt;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (arg == "--less") {
+            opt.less = true;
+            opt.objective = "time";
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return 1;
+        }
+
+        i++;
+
+        if (arg == "--type")
+            opt.type = value;
+        else if (arg == "--input")
+            opt.input = value;
+        else if (arg == "--objective")
+            opt.objective = value;
+        else if (arg == "--name")
+            opt.name = value;
+        else if (arg == "--min")
+            opt.min_size = std::strtoull(value, nullptr, 10);
+        else if (arg == "--max")
+            opt.max_size = std::strtoull(value, nullptr, 10);
+        else if (arg == "--mutations")
+            opt.mutations = unsigned(std::strtoul(value, nullptr, 10));
+        else if (arg == "--calc")
+            opt.calc_ms = std::strtod(value, nullptr);
+        else if (arg == "--seed")
+            opt.seed = unsigned(std::strtoul(value, nullptr, 10));
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    // std::string sorts run on prefix keys under the default policy, which
+    // only std::less<> reaches; the counting comparator would tune the gaps
+    // for the whole-string path that real string sorts do not take
+    if (opt.type == "string") {
+        opt.less = true;
+        opt.objective = "time";
+    }
+
+    if (opt.min_size < 2 || opt.max_size < opt.min_size || opt.max_size > std::size_t(std::numeric_limits<int>::max() / 2)) {
+        std::fprintf(stderr, "the size band must satisfy 2 <= min <= max <= 2^30\n");
+        return 1;
+    }
+
+    Tuner::Candidate best;
+
+    if (opt.type == "int")
+        best = Tuner::tune<int>(opt);
+    else if (opt.type == "int64")
+        best = Tuner::tune<std::int64_t>(opt);
+    else if (opt.type == "double")
+        best = Tuner::tune<double>(opt);
+    else if (opt.type == "string")
+        best = Tuner::tune<std::string>(opt);
+    else {
+        std::fprintf(stderr, "unknown type %s\n", opt.type.c_str());
+        return 1;
+    }
+
+    Tuner::emit(opt, best, stdout);
+}
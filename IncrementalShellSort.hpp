@@ -0,0 +1,157 @@
+#ifndef INCREMENTALSHELLSORT_HPP
+#define INCREMENTALSHELLSORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace IncrementalSortNS {
+    // From one dirty element in this many on, the whole array is sorted
+    // instead; on random int the two break even near one in ten.
+    constexpr std::size_t full_sort_divisor = 16;
+
+    // Restores the order of [first, last), sorted by comp but for the
+    // elements at the dirty indices, whatever their new values. The dirty
+    // elements are taken out and shell sorted with `Sequence`, their places
+    // found by galloping search among the others, and only the stretches of
+    // clean elements between a dirty element's old and new place are
+    // shifted, each in one move. For k dirty indices (duplicates are
+    // ignored) that is the shell sort of k elements, O(k log(n / k)) more
+    // comparisons and one move per element that changes place. A dirty
+    // element goes behind the clean ones equal to it.
+    template<class Sequence = FibFuzzyNS::Sequence<std::ptrdiff_t>, class Policy = ShellSortTemplate::DefaultPolicy, class Iterator, class IndexIterator, class Comparator = std::less<>>
+    void resort(Iterator first, Iterator last, IndexIterator dirty_first, IndexIterator dirty_last, Comparator comp = Comparator()) noexcept {
+        using Pointer = ShellSortTemplate::unwrapped_t<Iterator>;
+        using value_type = typename std::iterator_traits<Pointer>::value_type;
+        using T = typename std::iterator_traits<Pointer>::difference_type;
+
+        const Pointer a = ShellSortTemplate::unwrap(first, last);
+        const T size = std::distance(first, last);
+        std::vector<T> holes(dirty_first, dirty_last);
+
+        ShellSortTemplate::sort<decltype(holes.begin()), Sequence, std::less<>, Policy>(holes.begin(), holes.end());
+        holes.erase(std::unique(holes.begin(), holes.end()), holes.end());
+
+        const T k = T(holes.size());
+
+        if (k == 0)
+            return;
+
+        if (std::size_t(k) * full_sort_divisor >= std::size_t(size)) {
+            ShellSortTemplate::sort<Iterator, Sequence, Comparator, Policy>(first, last, comp);
+            return;
+        }
+
+        std::vector<value_type> values;
+        values.reserve(holes.size());
+
+        for (const T h : holes)
+            values.push_back(std::move(*(a + h)));
+
+        ShellSortTemplate::sort<value_type *, Sequence, Comparator, Policy>(values.data(), values.data() + k, comp);
+
+        // Clean element c, the c-th that is not dirty, is at c plus the
+        // number of holes[i] - i up to c.
+        for (T i = 0; i < k; i++)
+            holes[i] -= i;
+
+        const T clean = size - k;
+        const auto at = [&holes](const T c) {
+            return c + T(std::upper_bound(holes.begin(), holes.end(), c) - holes.begin());
+        };
+
+        // lands[j]: the number of clean elements that go before values[j]
+        std::vector<T> lands(holes.size());
+
+        for (T j = 0, from = 0; j < k; j++) {
+            T lo = from, hi = from;
+
+            // gallop from the place of the previous one, then bisect
+            for (T step = 1; hi < clean && !comp(values[j], *(a + at(hi))); step *= 2) {
+                lo = hi + 1;
+                hi = clean - hi > step ? hi + step : clean;
+            }
+
+            while (lo < hi) {
+                const T mid = lo + (hi - lo) / 2;
+
+                if (comp(values[j], *(a + at(mid))))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            lands[j] = from = lo;
+        }
+
+        // Between breakpoints, clean elements are contiguous both where they
+        // are and where they go, and move by the same shift: the dirty
+        // elements landing before them less the holes before them.
+        struct Stretch {
+            T from;
+            T count;
+            T shift;
+        };
+
+        std::vector<Stretch> stretches;
+
+        for (T c = 0, i = 0, j = 0; c < clean;) {
+            while (i < k && holes[i] <= c)
+                i++;
+            while (j < k && lands[j] <= c)
+                j++;
+
+            const T end = std::min({clean, i < k ? holes[i] : clean, j < k ? lands[j] : clean});
+
+            if (i != j)
+                stretches.push_back({c + i, end - c, j - i});
+
+            c = end;
+        }
+
+        // Left shifts in order and right shifts in reverse order only ever
+        // write to holes or to places already moved from.
+        for (const Stretch &s : stretches) {
+            if (s.shift < 0)
+                std::move(a + s.from, a + s.from + s.count, a + s.from + s.shift);
+        }
+
+        for (auto s = stretches.rbegin(); s != stretches.rend(); ++s) {
+            if (s->shift > 0)
+                std::move_backward(a + s->from, a + s->from + s->count, a + s->from + s->count + s->shift);
+        }
+
+        for (T j = 0; j < k; j++)
+            *(a + (lands[j] + j)) = std::move(values[j]);
+    }
+
+    // Restores the order of [first, last) when no element is more than
+    // `displacement` places from where it belongs. No pair further apart
+    // than twice that is then inverted, so only the gaps of `Sequence` up to
+    // it run, through the kernels of sort(), with neither the presortedness
+    // scan nor key encoding (floating point keys follow the comparator).
+    template<class Sequence = FibFuzzyNS::Sequence<std::ptrdiff_t>, class Policy = ShellSortTemplate::DefaultPolicy, class Iterator, class Comparator = std::less<>>
+    void resort_within(Iterator first, Iterator last, const std::size_t displacement, Comparator comp = Comparator()) noexcept {
+        const auto size = std::distance(first, last);
+        using Size = std::remove_const_t<decltype(size)>;
+
+        if (displacement == 0 || size < 2)
+            return;
+
+        if (displacement >= std::size_t(size) / 2 || (Policy::network_max_size > 0 && std::size_t(size) <= Policy::network_max_size)) {
+            ShellSortTemplate::sort<Iterator, Sequence, Comparator, Policy>(first, last, comp);
+            return;
+        }
+
+        ShellSortTemplate::narrow<Policy>(ShellSortTemplate::unwrap(first, last), comp, Size(size), Size(2 * displacement), 1, Sequence{});
+    }
+
+};
+
+#endif
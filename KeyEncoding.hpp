@@ -0,0 +1,108 @@
+#ifndef KEYENCODING_HPP
+#define KEYENCODING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include "SimdGapPass.hpp"
+
+namespace ShellSortTemplate {
+    namespace Keys {
+        // Unsigned integer whose order the encoded keys of V follow, void for
+        // types without an encoding.
+        template<class V, class = void>
+        struct unsigned_key {
+            using type = void;
+        };
+
+        template<class V>
+        struct unsigned_key<V, std::enable_if_t<std::is_integral_v<V> && std::is_signed_v<V>>> {
+            using type = std::make_unsigned_t<V>;
+        };
+
+        template<class V>
+        struct unsigned_key<V, std::enable_if_t<std::numeric_limits<V>::is_iec559 && sizeof(V) == 4>> {
+            using type = std::uint32_t;
+        };
+
+        template<class V>
+        struct unsigned_key<V, std::enable_if_t<std::numeric_limits<V>::is_iec559 && sizeof(V) == 8>> {
+            using type = std::uint64_t;
+        };
+
+        template<class V>
+        using unsigned_key_t = typename unsigned_key<V>::type;
+
+        template<class V>
+        constexpr bool encodable = !std::is_void_v<unsigned_key_t<V>>;
+
+        // Pointer ranges of signed integers, float or double ordered by
+        // std::less or std::greater.
+        template<class Iterator, class Compare>
+        constexpr bool supported = std::is_pointer_v<Iterator> &&
+                                   encodable<std::remove_pointer_t<Iterator>> &&
+                                   Simd::direction<Compare, std::remove_pointer_t<Iterator>>::value != 0;
+
+        // Signed integers flip their sign bit. Floating point numbers flip
+        // the sign bit when positive and every bit when negative, which is
+        // IEEE 754 totalOrder: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf
+        // < +NaN, NaNs ordered by payload. Decoding restores every bit.
+        template<class V>
+        unsigned_key_t<V> encode(const V v) noexcept {
+            using U = unsigned_key_t<V>;
+            constexpr U sign = U(1) << (std::numeric_limits<U>::digits - 1);
+
+            U bits;
+            std::memcpy(&bits, &v, sizeof(V));
+
+            if constexpr (std::is_integral_v<V>)
+                return bits ^ sign;
+            else
+                return bits & sign ? U(~bits) : U(bits ^ sign);
+        }
+
+        template<class V>
+        V decode(const unsigned_key_t<V> key) noexcept {
+            using U = unsigned_key_t<V>;
+            constexpr U sign = U(1) << (std::numeric_limits<U>::digits - 1);
+
+            U bits;
+
+            if constexpr (std::is_integral_v<V>)
+                bits = key ^ sign;
+            else
+                bits = key & sign ? U(key ^ sign) : U(~key);
+
+            V v;
+            std::memcpy(&v, &bits, sizeof(V));
+            return v;
+        }
+
+        // Replaces every element of [first, first + size) by its key, in the
+        // same storage, and returns the keys.
+        template<class V>
+        unsigned_key_t<V> *encode_range(V *first, const std::size_t size) noexcept {
+            using U = unsigned_key_t<V>;
+
+            for (std::size_t i = 0; i < size; i++) {
+                const U key = encode(first[i]);
+                ::new (static_cast<void *>(first + i)) U(key);
+            }
+
+            return std::launder(reinterpret_cast<U *>(first));
+        }
+
+        template<class V>
+        void decode_range(unsigned_key_t<V> *first, const std::size_t size) noexcept {
+            for (std::size_t i = 0; i < size; i++) {
+                const V v = decode<V>(first[i]);
+                ::new (static_cast<void *>(first + i)) V(v);
+            }
+        }
+    }
+}
+
+#endif
@@ -1,50 +1,35 @@
 #ifndef PS65SHELLSORT_HPP
 #define PS65SHELLSORT_HPP
 
-#include <limits>
+#include <cstdint>
 #include "ShellSortTemplate.hpp"
-#include "IntegralConstantArithmetic.hpp"
+#include "GapTable.hpp"
 
 namespace PS65NS {
-    using namespace IntegralConstantArithmetic;
+    // 2^k + 1, after a leading 1
+    inline constexpr std::intmax_t seeds[] = {1, 3};
+    inline constexpr auto next = [](const auto &f) { return f(1) + (f(1) - 1); };
 
-    template <class Numeric, size_t sz>
-    struct Number {
-        using type = add_t<typename Number<Numeric, sz - 1>::type,
-                     substract_t<typename Number<Numeric, sz - 1>::type, IC<Numeric, 1>>>;
-    };
-    
-    template <class Numeric>
-    struct Number<Numeric, 0> {
-        using type = IC<Numeric, 1>;
-    };
-    
     template <class Numeric>
-    struct Number<Numeric, 1> {
-        using type = IC<Numeric, 3>;
-    };
-    
+    constexpr auto gaps = GapTable::table<Numeric, seeds, next>;
+
     template <class Numeric = int>
     class Sequence {
         // Papernov & Stasevich number generator
         //
-        
-        static constexpr size_t table_size() {
-            return std::numeric_limits<Numeric>::digits;
-        }
-        
-        template <size_t ...I>
-        static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
-            return std::integer_sequence<Numeric, Number<Numeric, sizeof...(I) - I - 1>::type::value...>{};
-        }
 
         public:
-        using type = decltype(gen_seq(std::make_index_sequence<table_size()>())); 
+        using type = GapTable::sequence_t<gaps<Numeric>>;
     };
-    
+
     template<class Iterator, class Comparator=std::less<>>
     void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
         ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
     }
+
+    template<class Iterator, class Comparator>
+    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        ShellSortTemplate::sort<Iterator, Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp, threads);
+    }
 };
 #endif
@@ -0,0 +1,152 @@
+#ifndef PRATTSHELLSORT_HPP
+#define PRATTSHELLSORT_HPP
+
+#include <array>
+#include <limits>
+#include <thread>
+#include "ShellSortTemplate.hpp"
+
+namespace PrattNS {
+    // Number of 3-smooth numbers 2^p * 3^q representable in Numeric.
+    template <class Numeric>
+    constexpr size_t table_size() {
+        constexpr Numeric max_num = std::numeric_limits<Numeric>::max();
+        size_t sz = 0;
+
+        for (Numeric p2 = 1; ; p2 *= 2) {
+            for (Numeric p = p2; ; p *= 3) {
+                sz++;
+
+                if (p > max_num / 3)
+                    break;
+            }
+
+            if (p2 > max_num / 2)
+                break;
+        }
+
+        return sz;
+    }
+
+    // The 3-smooth numbers in descending order, merged from the doubles and
+    // the triples of the numbers found so far.
+    template <class Numeric>
+    constexpr std::array<Numeric, table_size<Numeric>()> table() {
+        constexpr Numeric max_num = std::numeric_limits<Numeric>::max();
+        constexpr size_t sz = table_size<Numeric>();
+        std::array<Numeric, sz> asc{};
+        size_t i2 = 0, i3 = 0;
+
+        asc[0] = 1;
+        for (size_t k = 1; k < sz; k++) {
+            const bool has2 = asc[i2] <= max_num / 2, has3 = asc[i3] <= max_num / 3;
+            const Numeric n2 = has2 ? asc[i2] * 2 : max_num, n3 = has3 ? asc[i3] * 3 : max_num;
+
+            asc[k] = (has2 && (!has3 || n2 <= n3)) ? n2 : n3;
+
+            if (has2 && n2 == asc[k])
+                i2++;
+            if (has3 && n3 == asc[k])
+                i3++;
+        }
+
+        std::array<Numeric, sz> desc{};
+        for (size_t k = 0; k < sz; k++)
+            desc[k] = asc[sz - k - 1];
+
+        return desc;
+    }
+
+    template <class Numeric>
+    constexpr auto gaps = table<Numeric>();
+
+    template <class Numeric = int>
+    class Sequence {
+        // Pratt 3-smooth number generator
+        //
+
+        template <size_t ...I>
+        static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
+            return std::integer_sequence<Numeric, gaps<Numeric>[I]...>{};
+        }
+
+        public:
+        using type = decltype(gen_seq(std::make_index_sequence<table_size<Numeric>()>()));
+    };
+
+    // Before the pass of gap h the array is already 2h- and 3h-sorted, so
+    // every element is at most one step of h out of place and the inverted
+    // pairs are disjoint. One compare-exchange per element therefore
+    // finishes the pass, in any order; small trivially copyable types do it
+    // with selects, which leaves the loop without branches and open to the
+    // compiler's vectorizer.
+    template<class Iterator, class Compare, class T>
+    constexpr void exchange_span(Iterator first, Compare &comp, const T gap, const T lo, const T hi) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        for (T i = lo; i < hi; i++) {
+            auto &a = *(first + (i - gap));
+            auto &b = *(first + i);
+
+            if constexpr (ShellSortTemplate::branchless_insertion<value_type>::value) {
+                const value_type x = a, y = b;
+                const bool swap = comp(y, x);
+
+                a = swap ? y : x;
+                b = swap ? x : y;
+            } else if (comp(b, a)) {
+                std::swap(a, b);
+            }
+        }
+    }
+
+    template<class Iterator, class Compare, class T>
+    constexpr void exchange_columns(Iterator first, Compare comp, const T size, const T gap, const T col_first, const T col_last) noexcept {
+        if (col_first == 0 && col_last == gap) {
+            exchange_span(first, comp, gap, gap, size);
+            return;
+        }
+
+        for (T base = gap; size - base > col_first; base += gap) {
+            exchange_span(first, comp, gap, base + col_first, base + std::min(col_last, size - base));
+
+            if (size - base <= gap)
+                break;
+        }
+    }
+
+    template<class Iterator, class Compare, class T, T ...Seq>
+    void sort_impl(Iterator first, Compare comp, const T size, std::integer_sequence<T, Seq...>, const unsigned threads) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr T min_width = T(std::max<std::size_t>(1, ShellSortTemplate::parallel_block_bytes / sizeof(value_type)));
+
+        for (const auto gap : {Seq...}) {
+            if (size > gap) {
+                ShellSortTemplate::for_column_blocks(size, gap, threads, min_width, [=](T col_first, T col_last) {
+                    exchange_columns(first, comp, size, gap, col_first, col_last);
+                });
+            }
+        }
+    }
+
+    template<class Iterator, class Comparator>
+    void shellsort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const auto size = std::distance(first, last);
+
+        if (size > 1)
+            sort_impl(ShellSortTemplate::unwrap(first, last), comp, size, typename Sequence<difference_type>::type{}, threads);
+    }
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        shellsort(first, last, comp, 1);
+    }
+
+};
+
+#endif
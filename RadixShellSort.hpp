@@ -0,0 +1,138 @@
+#ifndef RADIXSHELLSORT_HPP
+#define RADIXSHELLSORT_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace RadixSortNS {
+    constexpr std::size_t radix_bits = 8;
+    constexpr std::size_t buckets = std::size_t(1) << radix_bits;
+
+    // Smaller arrays are shell sorted directly.
+    constexpr std::size_t min_size = 1 << 12;
+
+    // Unsigned integer a V is partitioned by: unsigned integers as they are,
+    // signed integers and floating point through their encoded keys.
+    template<class V>
+    using radix_key_t = std::conditional_t<std::is_unsigned_v<V> && !std::is_same_v<V, bool>, V,
+                                           ShellSortTemplate::Keys::unsigned_key_t<V>>;
+
+    template<class Iterator, class Compare>
+    constexpr bool supported = std::is_pointer_v<Iterator> &&
+                               !std::is_void_v<radix_key_t<std::remove_pointer_t<Iterator>>> &&
+                               ShellSortTemplate::Simd::direction<Compare, std::remove_pointer_t<Iterator>>::value != 0;
+
+    // Shift of the highest byte in which the keys differ, so that keys
+    // drawn from a narrow range still spread over all the buckets; false
+    // when all keys are equal.
+    template<class U>
+    bool top_digit(const U *keys, const std::size_t size, unsigned &shift) noexcept {
+        U diff = 0;
+
+        for (std::size_t i = 1; i < size; i++)
+            diff |= keys[i] ^ keys[0];
+
+        if (diff == 0)
+            return false;
+
+        unsigned width = 0;
+        for (; width < unsigned(std::numeric_limits<U>::digits) && (diff >> width) != 0; width++) {}
+
+        shift = width > radix_bits ? width - unsigned(radix_bits) : 0;
+        return true;
+    }
+
+    // In-place (American flag) partition on the digit at `shift`: every
+    // key is swapped straight into the next free slot of its bucket.
+    // bounds[b] is where bucket b starts; descending sorts number the
+    // buckets from the top.
+    template<bool Greater, class U>
+    void partition(U *keys, const std::size_t size, const unsigned shift, std::size_t (&bounds)[buckets + 1]) noexcept {
+        const auto digit = [shift](const U key) {
+            const std::size_t d = std::size_t(key >> shift) & (buckets - 1);
+            return Greater ? buckets - 1 - d : d;
+        };
+
+        std::size_t next[buckets] = {};
+
+        for (std::size_t i = 0; i < size; i++)
+            next[digit(keys[i])]++;
+
+        bounds[0] = 0;
+        for (std::size_t b = 0; b < buckets; b++) {
+            bounds[b + 1] = bounds[b] + next[b];
+            next[b] = bounds[b];
+        }
+
+        for (std::size_t b = 0; b < buckets; b++) {
+            while (next[b] < bounds[b + 1]) {
+                U key = keys[next[b]];
+
+                for (std::size_t d = digit(key); d != b; d = digit(key))
+                    std::swap(key, keys[next[d]++]);
+
+                keys[next[b]++] = key;
+            }
+        }
+    }
+
+    template<class Sequence, class Policy, bool Greater, class U>
+    void sort_keys(U *keys, const std::size_t size) noexcept {
+        using Order = std::conditional_t<Greater, std::greater<>, std::less<>>;
+
+        unsigned shift;
+        if (!top_digit(keys, size, shift))
+            return;
+
+        std::size_t bounds[buckets + 1];
+        partition<Greater>(keys, size, shift, bounds);
+
+        // the gap passes skip the gaps that do not fit a bucket
+        for (std::size_t b = 0; b < buckets; b++)
+            ShellSortTemplate::sort<U *, Sequence, Order, Policy>(keys + bounds[b], keys + bounds[b + 1]);
+    }
+
+    // One MSD radix partition into 256 buckets on the highest byte in which
+    // the keys differ, then the gap passes of `Sequence` on every bucket.
+    // Element types or comparators without an unsigned key are shell sorted
+    // directly.
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = ShellSortTemplate::DefaultPolicy>
+    void sort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        using Base = ShellSortTemplate::unwrapped_t<Iterator>;
+        const std::size_t size = std::distance(first, last);
+
+        if constexpr (supported<Base, Comparator>) {
+            using V = std::remove_pointer_t<Base>;
+            constexpr bool greater = ShellSortTemplate::Simd::direction<Comparator, V>::value == 2;
+
+            if (size >= min_size) {
+                V *data = ShellSortTemplate::unwrap(first, last);
+
+                if constexpr (std::is_same_v<radix_key_t<V>, V>) {
+                    sort_keys<Sequence, Policy, greater>(data, size);
+                } else {
+                    auto *keys = ShellSortTemplate::Keys::encode_range(data, size);
+                    sort_keys<Sequence, Policy, greater>(keys, size);
+                    ShellSortTemplate::Keys::decode_range<V>(keys, size);
+                }
+
+                return;
+            }
+        }
+
+        ShellSortTemplate::sort<Iterator, Sequence, Comparator, Policy>(first, last, comp);
+    }
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        sort<Iterator, FibFuzzyNS::Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp);
+    }
+
+};
+
+#endif
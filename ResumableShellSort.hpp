@@ -0,0 +1,163 @@
+#ifndef RESUMABLESHELLSORT_HPP
+#define RESUMABLESHELLSORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace ResumableSortNS {
+    // Insertions made between two looks at the clock.
+    constexpr std::size_t slice = 4096;
+
+    template<class T, T ...Seq>
+    constexpr std::array<T, sizeof...(Seq)> table(std::integer_sequence<T, Seq...>) noexcept {
+        return {{Seq...}};
+    }
+
+    // A shell sort run in installments, for threads that must not block for
+    // the whole sort: run() advances it by a number of insertions, run_for()
+    // and run_until() by time, and each call picks up at the gap and the
+    // position the previous one stopped at. Leave the range alone between
+    // calls. The passes are those of sort() on one thread, through the same
+    // kernels and cache blocks, without what only pays off in a single
+    // call: the presortedness scan, fused passes and key encoding (floating
+    // point keys follow the comparator, not IEEE totalOrder).
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = ShellSortTemplate::DefaultPolicy>
+    class Sorter {
+        using Pointer = ShellSortTemplate::unwrapped_t<Iterator>;
+        using value_type = typename std::iterator_traits<Pointer>::value_type;
+        using T = typename std::iterator_traits<Pointer>::difference_type;
+
+        static constexpr auto gaps = table(typename ShellSortTemplate::rebind_sequence<Sequence, T>::type::type{});
+        static_assert(gaps.size() > 0 && gaps.back() == 1, "the sequence must end in the gap 1 pass");
+
+        Pointer first;
+        Comparator comp;
+        T size;
+        std::size_t k;  // current gap, gaps.size() once sorted
+        T width;        // column block width of the current pass, 0 when it runs row by row
+        T pos;          // next row position, or next column of a blocked pass
+
+        void start(const std::size_t gap) noexcept {
+            k = gap;
+
+            if (k < gaps.size()) {
+                width = ShellSortTemplate::block_width<Policy, Pointer>(size, gaps[k]);
+                pos = width ? 0 : gaps[k];
+            }
+        }
+
+        // Advances the current pass by about `limit` insertions, at least
+        // one, and returns how many it made.
+        std::size_t step(const std::size_t limit) noexcept {
+            const T gap = gaps[k];
+            std::size_t made;
+
+            if (width == 0) {
+                const T hi = pos + T(std::min(limit, std::size_t(size - pos)));
+
+                if (std::size_t(gap) < Policy::constant_gap_limit)
+                    ShellSortTemplate::constant_pass(first, comp, gap, pos, hi, std::make_index_sequence<Policy::constant_gap_limit - 1>());
+                else
+                    ShellSortTemplate::insert_span(first, comp, gap, pos, hi);
+
+                made = std::size_t(hi - pos);
+                pos = hi;
+
+                if (pos == size) {
+                    ShellSortTemplate::check_pass(first, comp, size, gap);
+                    start(k + 1);
+                }
+            } else {
+                // whole columns, no more than one cache block of them
+                const std::size_t rows = std::size_t((size - 1) / gap);
+                const T cols = std::min(T(std::clamp<std::size_t>(limit / rows, 1, std::size_t(width))), gap - pos);
+
+                ShellSortTemplate::sort_columns(first, comp, size, gap, pos, pos + cols);
+
+                made = std::size_t(cols) * rows;
+                pos += cols;
+
+                if (pos == gap) {
+                    ShellSortTemplate::check_pass(first, comp, size, gap);
+                    start(k + 1);
+                }
+            }
+
+            return made;
+        }
+
+        public:
+        Sorter(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept
+            : first(ShellSortTemplate::unwrap(first, last)), comp(comp), size(std::distance(first, last)), k(0), width(0), pos(0) {
+            if (size < 2) {
+                k = gaps.size();
+                return;
+            }
+
+            if constexpr (Policy::network_max_size > 0) {
+                if (std::size_t(size) <= Policy::network_max_size) {
+                    ShellSortTemplate::Network::sort<Policy::network_max_size, ShellSortTemplate::branchless_insertion<value_type>::value, Policy::unrolled_networks>(this->first, this->comp, std::size_t(size));
+                    k = gaps.size();
+                    return;
+                }
+            }
+
+            std::size_t g = 0;
+            while (std::size_t(gaps[g]) >= std::size_t(size))
+                g++;
+
+            start(g);
+        }
+
+        bool done() const noexcept {
+            return k == gaps.size();
+        }
+
+        // Makes at least `insertions` more insertions, each the placing of
+        // one element in its chain, or finishes the sort; returns done().
+        bool run(std::size_t insertions) noexcept {
+            while (!done() && insertions > 0)
+                insertions -= std::min(insertions, step(insertions));
+
+            return done();
+        }
+
+        // Runs slices of insertions until the deadline has passed, at least
+        // one slice per call so that a late caller still makes progress.
+        template<class Clock, class Duration>
+        bool run_until(const std::chrono::time_point<Clock, Duration> deadline) noexcept {
+            if (!done()) {
+                do {
+                    step(slice);
+                } while (!done() && Clock::now() < deadline);
+            }
+
+            return done();
+        }
+
+        template<class Rep, class Period>
+        bool run_for(const std::chrono::duration<Rep, Period> budget) noexcept {
+            return run_until(std::chrono::steady_clock::now() + budget);
+        }
+
+        void finish() noexcept {
+            run(std::numeric_limits<std::size_t>::max());
+        }
+    };
+
+    template<class Iterator, class Comparator = std::less<>>
+    Sorter<Iterator, FibFuzzyNS::Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator> sorter(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        return {first, last, comp};
+    }
+
+};
+
+#endif
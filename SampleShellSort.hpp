@@ -0,0 +1,139 @@
+#ifndef SAMPLESHELLSORT_HPP
+#define SAMPLESHELLSORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace SampleSortNS {
+    // Sample elements drawn per bucket when picking the splitters.
+    constexpr std::size_t oversampling = 128;
+
+    // Buckets smaller than this are not worth a thread of their own.
+    constexpr std::size_t min_bucket_size = 1 << 16;
+
+    template<class Iterator, class Comparator>
+    std::vector<typename std::iterator_traits<Iterator>::value_type>
+    pick_splitters(Iterator first, std::size_t size, Comparator comp, std::size_t buckets) {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        std::mt19937_64 gen(size);
+        std::uniform_int_distribution<std::size_t> dist(0, size - 1);
+        std::vector<value_type> sample;
+        sample.reserve(buckets * oversampling);
+
+        for (std::size_t i = 0; i < buckets * oversampling; i++)
+            sample.push_back(first[dist(gen)]);
+
+        FibFuzzyNS::shellsort(sample.begin(), sample.end(), comp);
+
+        std::vector<value_type> splitters;
+        splitters.reserve(buckets - 1);
+
+        for (std::size_t b = 1; b < buckets; b++)
+            splitters.push_back(std::move(sample[b * oversampling]));
+
+        return splitters;
+    }
+
+    // Parallel sample sort: the input is split into one bucket per thread by
+    // sampled splitters, scattered into a buffer, and every bucket is then
+    // finished by the shell sort kernel of `Sequence`. Without the memory
+    // for the buffer and the bucket ids, the input is shell sorted in place.
+    template<class Iterator, class Sequence, class Comparator = std::less<>>
+    void sort(Iterator first, Iterator last, Comparator comp = Comparator(), unsigned threads = 0) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using bucket_type = std::uint16_t;
+
+        const std::size_t size = std::distance(first, last);
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const std::size_t buckets = std::min<std::size_t>({threads, size / min_bucket_size, std::numeric_limits<bucket_type>::max()});
+
+        if (buckets < 2) {
+            ShellSortTemplate::sort<Iterator, Sequence, Comparator>(first, last, comp);
+            return;
+        }
+
+        std::vector<value_type> splitters;
+        std::vector<bucket_type> ids;
+        std::vector<std::size_t> counts, bucket_begin;
+        std::allocator<value_type> alloc;
+        value_type *buffer = nullptr;
+
+        // everything is allocated before the input is touched, so that it
+        // can still be shell sorted in place when memory runs out
+        const bool built = ShellSortTemplate::try_allocating([&] {
+            splitters = pick_splitters(first, size, comp, buckets);
+            ids.resize(size);
+            counts.assign(buckets * buckets, 0);
+            bucket_begin.assign(buckets + 1, 0);
+            buffer = alloc.allocate(size);
+        });
+
+        if (!built) {
+            ShellSortTemplate::sort<Iterator, Sequence, Comparator>(first, last, comp, threads);
+            return;
+        }
+
+        const auto chunk = [size, buckets](std::size_t t) { return size * t / buckets; };
+
+        // classify each chunk, counting how many of its elements land in each bucket
+        ShellSortTemplate::run_tasks(buckets, [&](std::size_t t) {
+            auto *count = &counts[t * buckets];
+
+            for (std::size_t i = chunk(t), e = chunk(t + 1); i < e; i++) {
+                const auto b = bucket_type(std::upper_bound(splitters.begin(), splitters.end(), first[i], comp) - splitters.begin());
+                ids[i] = b;
+                count[b]++;
+            }
+        });
+
+        // counts[t][b] becomes the buffer offset where chunk t writes bucket b
+        for (std::size_t b = 0, offset = 0; b < buckets; b++) {
+            bucket_begin[b] = offset;
+
+            for (std::size_t t = 0; t < buckets; t++) {
+                const auto c = counts[t * buckets + b];
+                counts[t * buckets + b] = offset;
+                offset += c;
+            }
+        }
+        bucket_begin[buckets] = size;
+
+        ShellSortTemplate::run_tasks(buckets, [&](std::size_t t) {
+            auto *offset = &counts[t * buckets];
+
+            for (std::size_t i = chunk(t), e = chunk(t + 1); i < e; i++)
+                ::new (static_cast<void *>(buffer + offset[ids[i]]++)) value_type(std::move(first[i]));
+        });
+
+        ShellSortTemplate::run_tasks(buckets, [&](std::size_t b) {
+            value_type *lo = buffer + bucket_begin[b], *hi = buffer + bucket_begin[b + 1];
+
+            ShellSortTemplate::sort<value_type *, Sequence, Comparator>(lo, hi, comp);
+            std::move(lo, hi, first + bucket_begin[b]);
+            std::destroy(lo, hi);
+        });
+
+        alloc.deallocate(buffer, size);
+    }
+
+    template<class Iterator, class Comparator=std::less<>>
+    void shellsort(Iterator first, Iterator last, Comparator comp = Comparator(), unsigned threads = 0) noexcept {
+        sort<Iterator, FibFuzzyNS::Sequence<typename std::iterator_traits<Iterator>::difference_type>, Comparator>(first, last, comp, threads);
+    }
+
+};
+
+#endif
@@ -2,35 +2,1062 @@
 #define SHELLSORTTEMPLATE_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#ifdef SHELLSORT_CHECK_PASSES
+#include <cassert>
+#endif
+#include "SimdGapPass.hpp"
+#include "StringPrefix.hpp"
+#include "KeyEncoding.hpp"
+#include "SortingNetwork.hpp"
 
 namespace ShellSortTemplate {
-    template<class Iterator, class Compare, class T, T ...Seq>
-    constexpr void sort_impl(Iterator first, Iterator last, Compare comp, const T size, std::integer_sequence<T, Seq...>) noexcept {
-        for (const auto gap : {Seq...}) {
-            if (size > gap) {
-                const auto h = first + gap;
-                for (auto i = h; i < last; i++) {
-                    if (comp(*i, *(i - gap))) {
-                        auto v = std::move(*i);
-                        auto j = i;
-
-                        do {
-                            *j = std::move(*(j - gap));
-                            j -= gap;
-                        } while (j >= h && comp(v, *(j - gap)));
-
-                        *j = std::move(v);
+    // Narrowest block of residue classes a worker thread is given, in bytes of
+    // one row, so that neighbouring blocks only meet at a single cache line.
+    constexpr std::size_t parallel_block_bytes = 1024;
+
+    // Passes with fewer insertions than this per thread run sequentially.
+    constexpr std::size_t parallel_min_work = 1 << 15;
+
+    // Chain steps the branchless insertion always takes before it falls
+    // back to the branchy loop for the rare long shifts.
+    constexpr std::size_t branchless_steps = 2;
+
+    // The pre-scan tests the array against lags that are powers of this.
+    constexpr std::size_t presort_lag_factor = 8;
+
+    // Shorter string ranges are not worth building prefix keys for.
+    constexpr std::size_t string_prefix_min_size = 64;
+
+    // Element types inserted by the branchless kernel. Small trivially
+    // copyable types qualify by default; specialise to opt a type in or out,
+    // e.g. when its comparator is too expensive to evaluate speculatively.
+    template<class T>
+    struct branchless_insertion : std::bool_constant<std::is_trivially_copyable_v<T> && sizeof(T) <= 2 * sizeof(void *)> {};
+
+    // Contiguous iterators of [first, last) are lowered to raw pointers so
+    // that the kernels specialised on pointers (the vector gap pass) see
+    // them too; an empty range, which has no element to take the address
+    // of, becomes a null pointer.
+    template<class Iterator>
+    constexpr auto unwrap(Iterator first, Iterator last) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if constexpr (!std::is_same_v<value_type, bool> && std::is_same_v<Iterator, typename std::vector<value_type>::iterator>)
+            return first == last ? static_cast<value_type *>(nullptr) : std::addressof(*first);
+        else
+            return first;
+    }
+
+    template<class Iterator>
+    using unwrapped_t = decltype(unwrap(std::declval<Iterator>(), std::declval<Iterator>()));
+
+    // The gap is either a plain integer or, for the narrow gaps unrolled by
+    // sort_impl, a std::integral_constant the compiler can fold.
+    template<class Iterator, class Compare, class Gap>
+    constexpr void insert(Iterator h, Iterator i, Compare &comp, const Gap gap) noexcept {
+        if (comp(*i, *(i - gap))) {
+            auto v = std::move(*i);
+            auto j = i;
+
+            do {
+                *j = std::move(*(j - gap));
+                j -= gap;
+            } while (j >= h && comp(v, *(j - gap)));
+
+            *j = std::move(v);
+        }
+    }
+
+    // Insertion that looks `branchless_steps` chain steps back at once: the
+    // neighbours are loaded and compared up front, independent of each
+    // other, and written back through conditional selects, so the shift
+    // distance never feeds a branch. Only elements that travel further
+    // continue in the branchy loop. Needs at least `branchless_steps` rows
+    // above i.
+    template<class Iterator, class Compare, class Gap>
+    constexpr void insert_branchless(Iterator h, Iterator i, Compare &comp, const Gap gap) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using T = typename std::iterator_traits<Iterator>::difference_type;
+
+        const value_type v = *i;
+        value_type prev[branchless_steps];
+        bool move[branchless_steps];
+
+        for (std::size_t s = 0; s < branchless_steps; s++)
+            prev[s] = *(i - T(s + 1) * gap);
+
+        // the chain above i is sorted, but masking keeps a comparator that is
+        // no strict weak order (NaN) from moving past an element it kept
+        move[0] = comp(v, prev[0]);
+        for (std::size_t s = 1; s < branchless_steps; s++)
+            move[s] = move[s - 1] & comp(v, prev[s]);
+
+        *i = move[0] ? prev[0] : v;
+        for (std::size_t s = 1; s < branchless_steps; s++)
+            *(i - T(s) * gap) = move[s] ? prev[s] : move[s - 1] ? v : prev[s - 1];
+
+        if (move[branchless_steps - 1]) {
+            auto j = i - T(branchless_steps) * gap;
+
+            while (j >= h && comp(v, *(j - gap))) {
+                *j = *(j - gap);
+                j -= gap;
+            }
+
+            *j = v;
+        }
+    }
+
+    // Inserts the elements at positions [lo, hi), all at least `gap` from
+    // the front, into their chains in order, with the fastest kernel the
+    // element type, comparator and chain depth allow.
+    template<class Iterator, class Compare, class Gap, class T>
+    constexpr void insert_span(Iterator first, Compare &comp, const Gap gap, const T lo, const T hi) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if constexpr (Simd::supported<Iterator, Compare>) {
+            if (Simd::insert_span<std::remove_pointer_t<Iterator>, Compare>(first, T(gap), lo, hi))
+                return;
+        }
+
+        const auto h = first + gap;
+        T i = lo;
+
+        if constexpr (branchless_insertion<value_type>::value) {
+            // the branchless kernel needs branchless_steps elements above i
+            const T deep = gap <= hi / T(branchless_steps) ? T(branchless_steps) * gap : hi;
+
+            for (; i < std::min(deep, hi); i++)
+                insert(h, first + i, comp, gap);
+
+            for (; i < hi; i++)
+                insert_branchless(h, first + i, comp, gap);
+        } else {
+            for (; i < hi; i++)
+                insert(h, first + i, comp, gap);
+        }
+    }
+
+    // One gap pass restricted to the residue classes [col_first, col_last).
+    // The array is swept row by row, a row being the next `gap` elements,
+    // so disjoint column blocks never touch each other.
+    template<class Iterator, class Compare, class T>
+    constexpr void sort_columns(Iterator first, Compare &comp, const T size, const T gap, const T col_first, const T col_last) noexcept {
+        if (col_first == 0 && col_last == gap) {
+            insert_span(first, comp, gap, gap, size);
+            return;
+        }
+
+        for (T base = gap; size - base > col_first; base += gap) {
+            insert_span(first, comp, gap, base + col_first, base + std::min(col_last, size - base));
+
+            if (size - base <= gap)
+                break;
+        }
+    }
+
+    // Runs the passes of `count` consecutive gaps in one streaming sweep.
+    // Each smaller gap trails the previous one by `fuse_lag_rows` of its
+    // rows, so it works on elements that were just brought into cache, and
+    // the larger gap's insertions seldom reach back past it. The result is
+    // not exactly the sequence of separate passes, which is why the final
+    // gap 1 pass is never fused.
+    template<class Policy, class Iterator, class Compare, class T>
+    void fused_pass(Iterator first, Compare &comp, const T size, const T *gaps, const std::size_t count) noexcept {
+        T lag[Policy::fused_gaps] = {};
+
+        for (std::size_t k = 1; k < count; k++)
+            lag[k] = lag[k - 1] + T(Policy::fuse_lag_rows) * gaps[k - 1];
+
+        const T chunk = T(Policy::fuse_chunk);
+        const T end = size + lag[count - 1];
+
+        for (T p = gaps[0]; p < end; p += std::min(chunk, end - p)) {
+            const T q = p + std::min(chunk, end - p);
+
+            for (std::size_t k = 0; k < count; k++) {
+                if (q <= lag[k])
+                    break;
+
+                const T lo = std::max(gaps[k], p - std::min(p, lag[k]));
+                const T hi = std::min(size, q - lag[k]);
+
+                if (lo < hi)
+                    insert_span(first, comp, gaps[k], lo, hi);
+            }
+        }
+    }
+
+    // Number of gaps from gaps[0] on that fused_pass may take together.
+    template<class Policy, class Iterator, class T>
+    constexpr std::size_t fusable(const T size, const T *gaps, const std::size_t count, const unsigned threads) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if (threads > 1 || std::size_t(size) * sizeof(value_type) <= Policy::fuse_window_bytes)
+            return 1;
+
+        std::size_t n = 1, window = 0;
+
+        while (n < std::min(count, Policy::fused_gaps) && gaps[n] > 1) {
+            window += Policy::fuse_lag_rows * std::size_t(gaps[n - 1]) * sizeof(value_type);
+
+            if (window > Policy::fuse_window_bytes)
+                break;
+
+            n++;
+        }
+
+        return n;
+    }
+
+    // Column blocks of a pass whose rows are wider than this many bytes are
+    // narrowed until all rows of one block fit in it together, so a block's
+    // chains stay cache resident while they are insertion sorted. Returns
+    // the block width, or 0 when the rows fit and the pass is not blocked.
+    template<class Policy, class Iterator, class T>
+    constexpr T block_width(const T size, const T gap) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr std::size_t line = std::max<std::size_t>(1, 64 / sizeof(value_type));
+
+        if (Policy::cache_block_bytes == 0 || std::size_t(gap) * sizeof(value_type) <= Policy::cache_block_bytes)
+            return 0;
+
+        const std::size_t rows = std::size_t(size / gap) + 1;
+        const std::size_t budget = Policy::cache_block_bytes / sizeof(value_type) / rows;
+
+        return T(std::max(line, budget / line * line));
+    }
+
+    template<class Policy, class Iterator, class Compare, class T>
+    void blocked_columns(Iterator first, Compare &comp, const T size, const T gap, const T col_first, const T col_last) noexcept {
+        const T width = block_width<Policy, Iterator>(size, gap);
+
+        if (width == 0) {
+            sort_columns(first, comp, size, gap, col_first, col_last);
+            return;
+        }
+
+        for (T col = col_first; col < col_last; col += std::min(width, col_last - col))
+            sort_columns(first, comp, size, gap, col, col + std::min(width, col_last - col));
+    }
+
+    // Runs task(t) for every t in [0, count): task 0 on the calling thread,
+    // the others each on a thread of its own with its own copy of task.
+    // When a thread cannot be started (std::thread throws once the system
+    // is out of threads), the tasks left run on the calling thread instead.
+    template<class Task>
+    void run_tasks(const std::size_t count, Task task) noexcept {
+        std::vector<std::thread> workers;
+        std::size_t t = 1;
+
+#if defined(__cpp_exceptions)
+        try {
+            workers.reserve(count - 1);
+
+            for (; t < count; t++)
+                workers.emplace_back(task, t);
+        } catch (const std::exception &) {
+        }
+#else
+        workers.reserve(count - 1);
+
+        for (; t < count; t++)
+            workers.emplace_back(task, t);
+#endif
+
+        task(std::size_t(0));
+
+        for (; t < count; t++)
+            task(t);
+
+        for (auto &w : workers)
+            w.join();
+    }
+
+    // Calls block(col_first, col_last) on up to `threads` disjoint column
+    // blocks of a gap pass at once, none narrower than `min_width`; passes
+    // too small to feed several threads run as a single block.
+    template<class T, class Block>
+    void for_column_blocks(const T size, const T gap, const unsigned threads, const T min_width, Block block) noexcept {
+        T blocks = std::min<T>(T(threads), gap / min_width);
+        blocks = std::min<T>(blocks, T((size - gap) / parallel_min_work));
+
+        if (blocks < 2) {
+            block(T(0), gap);
+            return;
+        }
+
+        const T width = gap / blocks, extra = gap % blocks;
+        const auto bound = [width, extra](T b) { return width * b + std::min(b, extra); };
+
+        run_tasks(std::size_t(blocks), [block, bound](const std::size_t b) mutable {
+            block(bound(T(b)), bound(T(b) + 1));
+        });
+    }
+
+    // Comparator of a guarded sort. It counts the comparisons of the current
+    // pass, and once they run past the pass budget it answers false to
+    // everything: every insertion then stops where it is, so the pass winds
+    // down in linear time and leaves a permutation behind. The column blocks
+    // of a threaded pass each count on their own copy against their share
+    // of the budget and only share the tripped flag.
+    template<class Compare>
+    struct GuardedCompare {
+        Compare comp;
+        std::atomic<bool> *tripped;
+        std::size_t count = 0;
+        std::size_t budget = 0;
+
+        template<class A, class B>
+        bool operator()(A &&a, B &&b) noexcept {
+            if (++count > budget) {
+                tripped->store(true, std::memory_order_relaxed);
+                return false;
+            }
+
+            return comp(std::forward<A>(a), std::forward<B>(b));
+        }
+    };
+
+    template<class Compare>
+    constexpr void start_guard(Compare &, std::size_t) noexcept {}
+
+    template<class Compare>
+    constexpr void start_guard(GuardedCompare<Compare> &comp, const std::size_t budget) noexcept {
+        comp.count = 0;
+        comp.budget = budget;
+    }
+
+    template<class Compare>
+    constexpr void share_guard(Compare &, std::size_t, std::size_t) noexcept {}
+
+    // Cuts the budget of a pass down to the share of `cols` of its `gap`
+    // columns, so that all blocks together stay within it.
+    template<class Compare>
+    constexpr void share_guard(GuardedCompare<Compare> &comp, const std::size_t cols, const std::size_t gap) noexcept {
+        comp.budget = comp.budget / gap * cols + comp.budget % gap * cols / gap;
+    }
+
+    template<class Policy, class Iterator, class Compare, class T>
+    void pass(Iterator first, Compare &comp, const T size, const T gap, const unsigned threads) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr T min_width = T(std::max<std::size_t>(1, parallel_block_bytes / sizeof(value_type)));
+
+        // every block works on its own copy of the comparator
+        for_column_blocks(size, gap, threads, min_width, [=](T col_first, T col_last) {
+            Compare block = comp;
+
+            share_guard(block, std::size_t(col_last - col_first), std::size_t(gap));
+            blocked_columns<Policy>(first, block, size, gap, col_first, col_last);
+        });
+    }
+
+    template<class Policy, class Iterator, class Compare, class T>
+    constexpr void check_guard(Iterator, Compare &, const T, const T, std::size_t &) noexcept {}
+
+    // A pass that ran out of budget hands the whole range to heapsort with
+    // the real comparator, and the remaining gaps are dropped.
+    template<class Policy, class Iterator, class Compare, class T>
+    void check_guard(Iterator first, GuardedCompare<Compare> &comp, const T size, const T gap, std::size_t &next) noexcept {
+        if (!comp.tripped->load(std::memory_order_relaxed))
+            return;
+
+        std::make_heap(first, first + size, comp.comp);
+        std::sort_heap(first, first + size, comp.comp);
+        Policy::on_fallback(std::size_t(gap));
+        next = std::numeric_limits<std::size_t>::max();
+    }
+
+    // With SHELLSORT_CHECK_PASSES defined, every gap pass that is not fused
+    // asserts that it left the array h-sorted, at O(n) per pass; a check
+    // for the kernels, not for production builds.
+    template<class Iterator, class Compare, class T>
+    void check_pass([[maybe_unused]] Iterator first, [[maybe_unused]] Compare &comp, [[maybe_unused]] const T size, [[maybe_unused]] const T gap) noexcept {
+#ifdef SHELLSORT_CHECK_PASSES
+        for (T i = gap; i < size; i++)
+            assert(!comp(*(first + i), *(first + (i - gap))));
+#endif
+    }
+
+    // A guarded pass that tripped is not sorted by its gap, and the
+    // comparisons of the check do not count against the budget.
+    template<class Iterator, class Compare, class T>
+    void check_pass(Iterator first, GuardedCompare<Compare> &comp, const T size, const T gap) noexcept {
+        if (!comp.tripped->load(std::memory_order_relaxed))
+            check_pass(first, comp.comp, size, gap);
+    }
+
+    // Runs the I-th gap of the sequence unless an earlier fused pass already
+    // took it or the array is known to be sorted by it (gap above `reach`).
+    // Gaps below Policy::constant_gap_limit reach the kernels as compile-time
+    // constants; they are too narrow to block or thread anyway.
+    template<class Policy, std::size_t I, class Iterator, class Compare, class T, T ...Seq>
+    void sort_gap(Iterator first, Compare &comp, const T size, std::integer_sequence<T, Seq...>, const T reach, const unsigned threads, std::size_t &next) noexcept {
+        constexpr T gaps[] = {Seq...};
+        constexpr T gap = gaps[I];
+
+        if (I < next || size <= gap || reach < gap)
+            return;
+
+        next = I + 1;
+
+        // comparisons a pass may make: one per element plus the
+        // speculative ones of the branchless kernel, plus the moves
+        const std::size_t budget = (Policy::guard_moves + 1 + branchless_steps) * std::size_t(size);
+
+        if constexpr (Policy::fused_gaps > 1) {
+            const auto fused = fusable<Policy, Iterator>(size, gaps + I, sizeof...(Seq) - I, threads);
+
+            if (fused > 1) {
+                start_guard(comp, fused * budget);
+                fused_pass<Policy>(first, comp, size, gaps + I, fused);
+                next = I + fused;
+                check_guard<Policy>(first, comp, size, gap, next);
+                return;
+            }
+        }
+
+        start_guard(comp, budget);
+
+        if constexpr (std::size_t(gap) < Policy::constant_gap_limit)
+            insert_span(first, comp, std::integral_constant<T, gap>{}, gap, size);
+        else
+            pass<Policy>(first, comp, size, gap, threads);
+
+        check_pass(first, comp, size, gap);
+        check_guard<Policy>(first, comp, size, gap, next);
+    }
+
+    template<class Policy, class Iterator, class Compare, class T, T ...Seq, std::size_t ...I>
+    void sort_impl(Iterator first, Compare comp, const T size, std::integer_sequence<T, Seq...> seq, const T reach, const unsigned threads, std::index_sequence<I...>) noexcept {
+        std::size_t next = 0;
+
+        (sort_gap<Policy, I>(first, comp, size, seq, reach, threads, next), ...);
+    }
+
+    template<class Policy, class Iterator, class Compare, class T, T ...Seq>
+    void sort_impl(Iterator first, Compare comp, const T size, std::integer_sequence<T, Seq...> seq, const T reach, const unsigned threads) noexcept {
+        sort_impl<Policy>(first, comp, size, seq, reach, threads, std::make_index_sequence<sizeof...(Seq)>());
+    }
+
+    // A gap sequence chosen at run time: `count` gaps from `first` on, in
+    // descending order. A table that does not end in 1 gets the gap 1 pass
+    // appended, so the array always ends up sorted.
+    struct Gaps {
+        const std::size_t *first;
+        std::size_t count;
+    };
+
+    template<class Iterator, class Compare, class T, T Gap>
+    void constant_span(Iterator first, Compare &comp, const T lo, const T hi) noexcept {
+        insert_span(first, comp, std::integral_constant<T, Gap>{}, lo, hi);
+    }
+
+    // Inserts [lo, hi) for a run-time gap below Policy::constant_gap_limit
+    // through the kernel stamped out for that gap as a constant, the same
+    // kernel a compile-time sequence gets.
+    template<class Iterator, class Compare, class T, std::size_t ...G>
+    void constant_pass(Iterator first, Compare &comp, const T gap, const T lo, const T hi, std::index_sequence<G...>) noexcept {
+        using Span = void (*)(Iterator, Compare &, T, T);
+        static constexpr Span spans[] = {&constant_span<Iterator, Compare, T, T(G + 1)>...};
+
+        spans[gap - 1](first, comp, lo, hi);
+    }
+
+    // The gap passes of sort_gap, driven by a run-time table.
+    template<class Policy, class Iterator, class Compare, class T>
+    void sort_impl(Iterator first, Compare comp, const T size, const Gaps gaps, const T reach, const unsigned threads) noexcept {
+        const bool ends_in_one = gaps.count > 0 && gaps.first[gaps.count - 1] == 1;
+        const std::size_t count = gaps.count + (ends_in_one ? 0 : 1);
+        const auto gap_at = [&gaps](std::size_t k) { return k < gaps.count ? gaps.first[k] : std::size_t(1); };
+
+        const std::size_t budget = (Policy::guard_moves + 1 + branchless_steps) * std::size_t(size);
+        std::size_t next = 0;
+
+        for (std::size_t k = 0; k < count; k++) {
+            if (k < next || std::size_t(size) <= gap_at(k) || std::size_t(reach) < gap_at(k))
+                continue;
+
+            const T gap = T(gap_at(k));
+            next = k + 1;
+
+            if constexpr (Policy::fused_gaps > 1) {
+                T fuse[Policy::fused_gaps];
+                std::size_t n = 0;
+
+                for (; n < Policy::fused_gaps && k + n < count; n++)
+                    fuse[n] = T(gap_at(k + n));
+
+                const auto fused = fusable<Policy, Iterator>(size, fuse, n, threads);
+
+                if (fused > 1) {
+                    start_guard(comp, fused * budget);
+                    fused_pass<Policy>(first, comp, size, fuse, fused);
+                    next = k + fused;
+                    check_guard<Policy>(first, comp, size, gap, next);
+                    continue;
+                }
+            }
+
+            start_guard(comp, budget);
+
+            if (std::size_t(gap) < Policy::constant_gap_limit)
+                constant_pass(first, comp, gap, gap, size, std::make_index_sequence<Policy::constant_gap_limit - 1>());
+            else
+                pass<Policy>(first, comp, size, gap, threads);
+
+            check_pass(first, comp, size, gap);
+            check_guard<Policy>(first, comp, size, gap, next);
+        }
+    }
+
+    template<class T>
+    struct Presortedness {
+        bool ascending;     // no element is before its predecessor
+        bool descending;    // every element is before its predecessor
+        T reach;            // the array is h-sorted for every h above this
+    };
+
+    // O(n) scan in front of the gap passes. An element before the running
+    // maximum is out of place, and only those are tested against the lags
+    // L = 8, 64, 512, ...: if no element is before the maximum of the
+    // elements more than L positions back, no pair (i - h, i) with h > L is
+    // inverted and those passes would not move anything. The maximum of
+    // every lag is caught up lazily at the out-of-place elements, so ordered
+    // stretches cost a single comparison per element and the scan stops as
+    // soon as the array is known to be unordered at every lag.
+    template<class Iterator, class Compare, class T>
+    Presortedness<T> presortedness(Iterator first, Compare &comp, const T size) noexcept {
+        constexpr std::size_t max_lags = std::numeric_limits<T>::digits / 3 + 1;
+        constexpr T lag_limit = std::numeric_limits<T>::max() / T(presort_lag_factor);
+
+        T lag[max_lags], folded[max_lags], top[max_lags];
+        std::size_t lags = 0, alive = 0;
+
+        for (T l = T(presort_lag_factor); l < size; l *= T(presort_lag_factor)) {
+            lag[lags] = l;
+            folded[lags] = 0;
+            top[lags] = 0;
+            lags++;
+
+            if (l > lag_limit)
+                break;
+        }
+
+        bool ascending = true, descending = true;
+        T peak = 0;
+
+        for (T i = 1; i < size; i++) {
+            const bool down = comp(*(first + i), *(first + (i - 1)));
+
+            ascending = ascending && !down;
+            descending = descending && down;
+
+            if (!down && peak == i - 1) {
+                peak = i;
+                continue;
+            }
+
+            // a strictly descending prefix ends in its smallest element
+            if (!descending && !comp(*(first + i), *(first + peak))) {
+                peak = i;
+                continue;
+            }
+
+            // the smallest lag still alive decides; larger lags look at a
+            // prefix of its window and hold whenever it holds
+            while (alive < lags && i > lag[alive]) {
+                const T bound = i - lag[alive];
+
+                for (T p = folded[alive]; p < bound; p++) {
+                    if (comp(*(first + top[alive]), *(first + p)))
+                        top[alive] = p;
+                }
+
+                folded[alive] = bound;
+
+                if (!comp(*(first + i), *(first + top[alive])))
+                    break;
+
+                alive++;
+            }
+
+            if (!ascending && !descending && alive == lags)
+                break;
+        }
+
+        return {ascending, descending, alive < lags ? lag[alive] : size};
+    }
+
+    // The same sequence generated in another index type, for sequences that
+    // are a class template over it like every *NS::Sequence.
+    template<class Sequence, class Numeric>
+    struct rebind_sequence {
+        using type = Sequence;
+    };
+
+    template<template<class> class Sequence, class Source, class Numeric>
+    struct rebind_sequence<Sequence<Source>, Numeric> {
+        using type = Sequence<Numeric>;
+    };
+
+    // Arrays small enough for 32-bit offsets sort with the 32-bit gap table,
+    // which is also trimmed to the gaps that fit; the headroom keeps offsets
+    // such as size plus a fused pass lag from overflowing. Larger ones take
+    // the table generated in their own offset type.
+    template<class Policy, class Sequence, class Iterator, class Compare, class Size>
+    void narrow(Iterator first, Compare &comp, const Size size, const Size reach, const unsigned threads, const Sequence &sequence) noexcept {
+        using Narrow = typename rebind_sequence<Sequence, std::int32_t>::type;
+        using Wide = typename rebind_sequence<Sequence, Size>::type;
+        constexpr bool runtime = std::is_same_v<Sequence, Gaps>;
+
+        if constexpr (Policy::narrow_indices && sizeof(Size) > sizeof(std::int32_t) && (runtime || !std::is_same_v<Narrow, Sequence>)) {
+            if (size <= Size(std::numeric_limits<std::int32_t>::max() / 2)) {
+                if constexpr (runtime)
+                    sort_impl<Policy>(first, comp, std::int32_t(size), sequence, std::int32_t(reach), threads);
+                else
+                    sort_impl<Policy>(first, comp, std::int32_t(size), typename Narrow::type{}, std::int32_t(reach), threads);
+                return;
+            }
+        }
+
+        if constexpr (runtime)
+            sort_impl<Policy>(first, comp, size, sequence, reach, threads);
+        else
+            sort_impl<Policy>(first, comp, size, typename Wide::type{}, reach, threads);
+    }
+
+    template<class Policy, class Sequence, class Iterator, class Compare, class Size>
+    void dispatch(Iterator first, Compare comp, const Size size, const unsigned threads, const Sequence &sequence) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+        if constexpr (Policy::network_max_size > 0) {
+            if (std::size_t(size) <= Policy::network_max_size) {
+                Network::sort<Policy::network_max_size, branchless_insertion<value_type>::value, Policy::unrolled_networks>(first, comp, std::size_t(size));
+                return;
+            }
+        }
+
+        Size reach = size;
+
+        if constexpr (Policy::presort_scan) {
+            const auto scan = presortedness(first, comp, size);
+
+            if (scan.ascending)
+                return;
+
+            if (scan.descending) {
+                std::reverse(first, first + size);
+                return;
+            }
+
+            reach = scan.reach;
+        }
+
+        if constexpr (Policy::guard_moves > 0) {
+            std::atomic<bool> tripped{false};
+            GuardedCompare<Compare> guarded{comp, &tripped};
+
+            narrow<Policy>(first, guarded, size, reach, threads, sequence);
+        } else {
+            narrow<Policy>(first, comp, size, reach, threads, sequence);
+        }
+    }
+
+    // Orders cached keys by their key alone.
+    template<class Compare>
+    struct ByKey {
+        Compare comp;
+
+        template<class A, class B>
+        constexpr bool operator()(const A &a, const B &b) noexcept {
+            return comp(a.key, b.key);
+        }
+    };
+
+    template<class Key, class Index>
+    struct KeyIndex {
+        Key key;
+        Index index;
+    };
+
+    // Rearranges the range so that element i becomes the one that was at
+    // index[i], following the cycles of the permutation: every element is
+    // moved once, plus one extra move per cycle. The index array is used to
+    // mark the visited positions and is left as the identity.
+    template<class Iterator, class Index>
+    void apply_permutation(Iterator first, Index *index, const std::size_t size) noexcept {
+        for (std::size_t i = 0; i < size; i++) {
+            if (std::size_t(index[i]) == i)
+                continue;
+
+            auto v = std::move(*(first + i));
+            std::size_t j = i;
+
+            for (std::size_t k = index[j]; k != i; k = index[j]) {
+                *(first + j) = std::move(*(first + k));
+                index[j] = Index(j);
+                j = k;
+            }
+
+            *(first + j) = std::move(v);
+            index[j] = Index(j);
+        }
+    }
+
+    // Runs build() and tells whether it found the memory it allocates;
+    // without exceptions running out of memory ends the program anyway.
+    template<class Build>
+    bool try_allocating(Build build) noexcept {
+#if defined(__cpp_exceptions)
+        try {
+            build();
+        } catch (const std::bad_alloc &) {
+            return false;
+        }
+#else
+        build();
+#endif
+        return true;
+    }
+
+    // Strings are sorted through 64-bit keys holding their next few bytes,
+    // paired with the string's index: the gap passes move 16-byte pairs and
+    // compare integers only. Runs of equal keys whose strings go on are
+    // sorted again on the bytes after their common prefix, like a multikey
+    // radix sort whose digits are the key words, and the strings are
+    // permuted into place at the end.
+    template<class Policy, class Sequence, class Iterator, class Compare, class Size>
+    void sort_strings(Iterator first, Compare comp, const Size size, const unsigned threads, const Sequence &sequence) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using Order = std::conditional_t<Simd::direction<Compare, value_type>::value == 2, std::greater<>, std::less<>>;
+
+        if (!Policy::string_prefix_keys || std::size_t(size) < string_prefix_min_size) {
+            dispatch<Policy>(first, comp, size, threads, sequence);
+            return;
+        }
+
+        const auto by_index = [&](auto width) {
+            using Index = decltype(width);
+            using Entry = KeyIndex<std::uint64_t, Index>;
+
+            struct Run {
+                std::size_t lo, hi, offset;
+            };
+
+            std::vector<Index> index;
+
+            const bool built = try_allocating([&] {
+                std::vector<Entry> keys(size);
+                for (Size i = 0; i < size; i++)
+                    keys[i] = {0, Index(i)};
+
+                std::vector<Run> runs{{0, std::size_t(size), 0}};
+
+                while (!runs.empty()) {
+                    const Run run = runs.back();
+                    runs.pop_back();
+
+                    Entry *entries = keys.data() + run.lo;
+                    const std::size_t n = run.hi - run.lo;
+                    const std::size_t offset = run.offset + Strings::common_prefix(first, entries, n, run.offset);
+
+                    for (std::size_t i = 0; i < n; i++)
+                        entries[i].key = Strings::key(*(first + entries[i].index), offset);
+
+                    dispatch<Policy>(entries, ByKey<Order>{}, Size(n), run.lo == 0 && run.hi == std::size_t(size) ? threads : 1, sequence);
+
+                    for (std::size_t i = 0, j; i < n; i = j) {
+                        for (j = i + 1; j < n && entries[j].key == entries[i].key; j++) {}
+
+                        if (j - i > 1 && Strings::continues(entries[i].key))
+                            runs.push_back({run.lo + i, run.lo + j, offset + Strings::key_bytes});
                     }
                 }
+
+                index.resize(size);
+                for (Size i = 0; i < size; i++)
+                    index[i] = keys[i].index;
+            });
+
+            // the strings have not moved yet, so they can still be sorted
+            // in place when the keys do not fit in memory
+            if (!built) {
+                dispatch<Policy>(first, comp, size, threads, sequence);
+                return;
             }
+
+            apply_permutation(first, index.data(), size);
+        };
+
+        if (std::size_t(size) <= std::numeric_limits<std::uint32_t>::max())
+            by_index(std::uint32_t(0));
+        else
+            by_index(std::size_t(0));
+    }
+
+    // Signed integers, float and double are sorted as their order-preserving
+    // unsigned keys, in place, and decoded afterwards; floating point then
+    // follows IEEE totalOrder, NaNs included.
+    template<class Policy, class Sequence, class V, class Compare, class Size>
+    void sort_encoded(V *first, Compare, const Size size, const unsigned threads, const Sequence &sequence) noexcept {
+        using Order = std::conditional_t<Simd::direction<Compare, V>::value == 2, std::greater<>, std::less<>>;
+
+        auto *keys = Keys::encode_range(first, std::size_t(size));
+        dispatch<Policy>(keys, Order{}, size, threads, sequence);
+        Keys::decode_range<V>(keys, std::size_t(size));
+    }
+
+    // Picks the engine for the element type and comparator.
+    template<class Policy, class Sequence, class Iterator, class Compare, class Size>
+    void route(Iterator first, Compare comp, const Size size, const unsigned threads, const Sequence &sequence) noexcept {
+        if constexpr (Strings::supported<Iterator, Compare>)
+            sort_strings<Policy>(first, comp, size, threads, sequence);
+        else if constexpr (Policy::encode_keys && Keys::supported<Iterator, Compare>)
+            sort_encoded<Policy>(first, comp, size, threads, sequence);
+        else
+            dispatch<Policy>(first, comp, size, threads, sequence);
+    }
+
+    // Compile-time knobs of sort(); derive from it to override single members.
+    struct DefaultPolicy {
+        // Rows of a gap pass wider than this are swept in cache-sized column
+        // blocks; 0 sweeps every pass row by row over the whole array.
+        static constexpr std::size_t cache_block_bytes = 256 * 1024;
+
+        // Consecutive gaps swept together by one fused pass (1 turns fusing
+        // off). Only gaps whose trailing window fits in fuse_window_bytes are
+        // fused, and only on arrays larger than that window.
+        static constexpr std::size_t fused_gaps = 1;
+        static constexpr std::size_t fuse_window_bytes = 256 * 1024;
+        static constexpr std::size_t fuse_lag_rows = 4;
+        static constexpr std::size_t fuse_chunk = 1024;
+
+        // Gaps below this are unrolled into kernels with the gap as a
+        // compile-time constant.
+        static constexpr std::size_t constant_gap_limit = 64;
+
+        // Arrays below 2^30 elements sort with 32-bit offsets and gap table.
+        static constexpr bool narrow_indices = true;
+
+        // Scan the array first: sorted input returns at once, strictly
+        // descending input is reversed, and gaps the array is already sorted
+        // by are skipped.
+        static constexpr bool presort_scan = true;
+
+        // Arrays up to this size are sorted by a sorting network instead of
+        // the gap passes (0 turns the networks off, at most
+        // Network::max_size).
+        static constexpr std::size_t network_max_size = 32;
+
+        // Stamp every network out as straight-line code, faster on small
+        // arrays but seconds of compile time per element type and comparator;
+        // otherwise one loop per type walks a shared table of comparators.
+        static constexpr bool unrolled_networks = false;
+
+        // Moves per element a single gap pass may make before the sort gives
+        // up on the gap sequence and heap sorts the array instead; 0 turns
+        // the guard off. Guarded sorts use the scalar kernels only.
+        static constexpr std::size_t guard_moves = 0;
+
+        // Called with the gap whose pass tripped the guard.
+        static void on_fallback(std::size_t) noexcept {}
+
+        // Sort std::string and std::string_view ranges through cached
+        // 64-bit prefix keys. They take 20 bytes per string (24 past 2^32
+        // strings) on the heap for the sort; when that cannot be allocated
+        // the strings are sorted in place.
+        static constexpr bool string_prefix_keys = true;
+
+        // Sort signed integers, float and double as unsigned keys; float and
+        // double then follow IEEE totalOrder (-0.0 before +0.0, NaNs at the
+        // ends by sign).
+        static constexpr bool encode_keys = true;
+    };
+
+    // Not constexpr: the engines route() picks allocate, encode keys in
+    // place and run vector kernels, none of which a constant expression may.
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
+        const auto size = std::distance(first, last);
+
+        if (size > 1)
+            route<Policy>(unwrap(first, last), comp, size, 1, Sequence{});
+    }
+
+    // Spreads the residue classes of every large gap over `threads` workers
+    // (all hardware threads when zero); small gaps stay sequential.
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort(Iterator first, Iterator last, Comparator comp, unsigned threads) noexcept {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const auto size = std::distance(first, last);
+
+        if (size > 1)
+            route<Policy>(unwrap(first, last), comp, size, threads, Sequence{});
+    }
+
+    // Sorts with a gap sequence picked at run time, e.g. from the registry in
+    // GapRegistry.hpp; `threads` as above. Zero gaps, which a table read
+    // from a configuration may hold, are skipped.
+    template<class Iterator, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort(Iterator first, Iterator last, const Gaps gaps, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const auto size = std::distance(first, last);
+
+        if (size < 2)
+            return;
+
+        if (std::find(gaps.first, gaps.first + gaps.count, std::size_t(0)) != gaps.first + gaps.count) {
+            std::vector<std::size_t> nonzero;
+            std::copy_if(gaps.first, gaps.first + gaps.count, std::back_inserter(nonzero), [](std::size_t gap) { return gap != 0; });
+
+            route<Policy>(unwrap(first, last), comp, size, threads, Gaps{nonzero.data(), nonzero.size()});
+            return;
+        }
+
+        route<Policy>(unwrap(first, last), comp, size, threads, gaps);
+    }
+
+    // Orders elements by comp(proj(a), proj(b)).
+    template<class Projection, class Compare>
+    struct Projected {
+        Projection proj;
+        Compare comp;
+
+        template<class A, class B>
+        constexpr bool operator()(A &&a, B &&b) noexcept {
+            return comp(std::invoke(proj, std::forward<A>(a)), std::invoke(proj, std::forward<B>(b)));
+        }
+    };
+
+    // Orders indices by the elements they point at.
+    template<class Iterator, class Compare>
+    struct Indirect {
+        Iterator first;
+        Compare comp;
+
+        template<class Index>
+        constexpr bool operator()(const Index a, const Index b) noexcept {
+            return comp(*(first + a), *(first + b));
         }
+    };
+
+    // Fills index[0, size) with the positions of the elements in sorted
+    // order, leaving the elements where they are. Index is usually a 32- or
+    // 64-bit unsigned integer.
+    template<class Iterator, class Sequence, class Index, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void argsort(Iterator first, Iterator last, Index *index, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        using Base = unwrapped_t<Iterator>;
+
+        const std::size_t size = std::distance(first, last);
+
+        for (std::size_t i = 0; i < size; i++)
+            index[i] = Index(i);
+
+        sort<Index *, Sequence, Indirect<Base, Comparator>, Policy>(index, index + size, {unwrap(first, last), comp}, threads);
+    }
+
+    // Sorts through an index array and applies the permutation at the end,
+    // so each element moves about once instead of once per chain step of
+    // every pass; meant for large elements that are expensive to move.
+    // When the index cannot be allocated, the elements are sorted directly.
+    template<class Iterator, class Sequence, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort_indirect(Iterator first, Iterator last, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        const std::size_t size = std::distance(first, last);
+
+        if (size < 2)
+            return;
+
+        const auto by_index = [&](auto width) {
+            using Index = decltype(width);
+
+            std::vector<Index> index;
+
+            if (!try_allocating([&] { index.resize(size); })) {
+                sort<Iterator, Sequence, Comparator, Policy>(first, last, comp, threads);
+                return;
+            }
+
+            argsort<Iterator, Sequence, Index, Comparator, Policy>(first, last, index.data(), comp, threads);
+            apply_permutation(first, index.data(), size);
+        };
+
+        if (size <= std::numeric_limits<std::uint32_t>::max())
+            by_index(std::uint32_t(0));
+        else
+            by_index(std::size_t(0));
     }
 
-    template<class Iterator, class Sequence, class Comparator = std::less<>>
-    constexpr void sort(Iterator first, Iterator last, Comparator comp = Comparator()) noexcept {
-        sort_impl(first, last, comp, std::distance(first, last), typename Sequence::type{});
+    // Sorts by a projection that is evaluated at every comparison; cheap
+    // projections such as member access are best used this way.
+    template<class Iterator, class Sequence, class Projection, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort_by(Iterator first, Iterator last, Projection proj, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        sort<Iterator, Sequence, Projected<Projection, Comparator>, Policy>(first, last, {proj, comp}, threads);
+    }
+
+    // Sorts by a projection that is evaluated once per element: the keys are
+    // stored next to their element's index, the gap passes run on those
+    // compact pairs, and the elements are permuted into order at the end.
+    // When the keys cannot be allocated, it sorts as sort_by() does.
+    template<class Iterator, class Sequence, class Projection, class Comparator = std::less<>, class Policy = DefaultPolicy>
+    void sort_by_cached_key(Iterator first, Iterator last, Projection proj, Comparator comp = Comparator(), unsigned threads = 1) noexcept {
+        using reference = typename std::iterator_traits<Iterator>::reference;
+        using key_type = std::decay_t<std::invoke_result_t<Projection &, reference>>;
+
+        const std::size_t size = std::distance(first, last);
+
+        if (size < 2)
+            return;
+
+        const auto by_index = [&](auto width) {
+            using Index = decltype(width);
+            using Pair = KeyIndex<key_type, Index>;
+
+            std::vector<Index> index;
+
+            const bool built = try_allocating([&] {
+                std::vector<Pair> keys;
+                keys.reserve(size);
+
+                auto it = first;
+                for (std::size_t i = 0; i < size; i++, ++it)
+                    keys.push_back({std::invoke(proj, *it), Index(i)});
+
+                sort<Pair *, Sequence, ByKey<Comparator>, Policy>(keys.data(), keys.data() + size, {comp}, threads);
+
+                index.resize(size);
+                for (std::size_t i = 0; i < size; i++)
+                    index[i] = keys[i].index;
+            });
+
+            if (!built) {
+                sort_by<Iterator, Sequence, Projection, Comparator, Policy>(first, last, proj, comp, threads);
+                return;
+            }
+
+            apply_permutation(first, index.data(), size);
+        };
+
+        if (size <= std::numeric_limits<std::uint32_t>::max())
+            by_index(std::uint32_t(0));
+        else
+            by_index(std::size_t(0));
     }
 }
 
@@ -0,0 +1,335 @@
+#ifndef SIMDGAPPASS_HPP
+#define SIMDGAPPASS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHELLSORT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ShellSortTemplate {
+    namespace Simd {
+        // 1 for ascending, 2 for descending, 0 for comparators the vector
+        // kernels do not understand.
+        template<class Compare, class V>
+        struct direction : std::integral_constant<int, 0> {};
+
+        template<class V>
+        struct direction<std::less<>, V> : std::integral_constant<int, 1> {};
+
+        template<class V>
+        struct direction<std::less<V>, V> : std::integral_constant<int, 1> {};
+
+        template<class V>
+        struct direction<std::greater<>, V> : std::integral_constant<int, 2> {};
+
+        template<class V>
+        struct direction<std::greater<V>, V> : std::integral_constant<int, 2> {};
+
+        // 0 for signed integers, 1 for unsigned integers, 2 for floating point
+        template<class V>
+        constexpr int kind = std::is_floating_point_v<V> ? 2 : std::is_unsigned_v<V> ? 1 : 0;
+
+        template<class V>
+        constexpr bool lane_type = std::is_arithmetic_v<V> && !std::is_same_v<V, bool> && (sizeof(V) == 4 || sizeof(V) == 8);
+
+        template<class Iterator, class Compare>
+        constexpr bool supported = std::is_pointer_v<Iterator> &&
+                                   lane_type<std::remove_pointer_t<Iterator>> &&
+                                   direction<Compare, std::remove_cv_t<std::remove_pointer_t<Iterator>>>::value != 0;
+
+        template<bool Greater, class V>
+        constexpr bool before(const V a, const V b) noexcept {
+            return Greater ? b < a : a < b;
+        }
+
+#ifdef SHELLSORT_SIMD_X86
+        enum class Level { scalar, avx2, avx512 };
+
+        inline Level cpu_level() noexcept {
+            static const Level level = [] {
+                __builtin_cpu_init();
+
+                if (__builtin_cpu_supports("avx512f"))
+                    return Level::avx512;
+                if (__builtin_cpu_supports("avx2"))
+                    return Level::avx2;
+                return Level::scalar;
+            }();
+
+            return level;
+        }
+
+        struct Avx2;
+        struct Avx512;
+
+        template<class ISA, std::size_t Size, int Kind>
+        struct Ops;
+
+#define SHELLSORT_AVX2 __attribute__((target("avx2"), always_inline))
+#define SHELLSORT_AVX512 __attribute__((target("avx512f"), always_inline))
+
+        struct Avx2Int {
+            using reg = __m256i;
+            using mask = __m256i;
+
+            template<class V>
+            static inline SHELLSORT_AVX2 reg load(const V *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+            template<class V>
+            static inline SHELLSORT_AVX2 void store(V *p, reg v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+            static inline SHELLSORT_AVX2 mask all() { return _mm256_set1_epi32(-1); }
+            static inline SHELLSORT_AVX2 mask land(mask a, mask b) { return _mm256_and_si256(a, b); }
+            static inline SHELLSORT_AVX2 bool any(mask m) { return !_mm256_testz_si256(m, m); }
+            static inline SHELLSORT_AVX2 reg select(mask m, reg t, reg f) { return _mm256_blendv_epi8(f, t, m); }
+        };
+
+        template<>
+        struct Ops<Avx2, 4, 0> : Avx2Int {
+            static constexpr std::size_t lanes = 8;
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) { return _mm256_cmpgt_epi32(b, a); }
+        };
+
+        template<>
+        struct Ops<Avx2, 4, 1> : Avx2Int {
+            static constexpr std::size_t lanes = 8;
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) {
+                const reg sign = _mm256_set1_epi32(INT32_MIN);
+                return _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+            }
+        };
+
+        template<>
+        struct Ops<Avx2, 8, 0> : Avx2Int {
+            static constexpr std::size_t lanes = 4;
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) { return _mm256_cmpgt_epi64(b, a); }
+        };
+
+        template<>
+        struct Ops<Avx2, 8, 1> : Avx2Int {
+            static constexpr std::size_t lanes = 4;
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) {
+                const reg sign = _mm256_set1_epi64x(INT64_MIN);
+                return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+            }
+        };
+
+        template<>
+        struct Ops<Avx2, 4, 2> {
+            using reg = __m256;
+            using mask = __m256;
+            static constexpr std::size_t lanes = 8;
+
+            static inline SHELLSORT_AVX2 reg load(const float *p) { return _mm256_loadu_ps(p); }
+            static inline SHELLSORT_AVX2 void store(float *p, reg v) { _mm256_storeu_ps(p, v); }
+            static inline SHELLSORT_AVX2 mask all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+            static inline SHELLSORT_AVX2 mask land(mask a, mask b) { return _mm256_and_ps(a, b); }
+            static inline SHELLSORT_AVX2 bool any(mask m) { return _mm256_movemask_ps(m) != 0; }
+            static inline SHELLSORT_AVX2 reg select(mask m, reg t, reg f) { return _mm256_blendv_ps(f, t, m); }
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        };
+
+        template<>
+        struct Ops<Avx2, 8, 2> {
+            using reg = __m256d;
+            using mask = __m256d;
+            static constexpr std::size_t lanes = 4;
+
+            static inline SHELLSORT_AVX2 reg load(const double *p) { return _mm256_loadu_pd(p); }
+            static inline SHELLSORT_AVX2 void store(double *p, reg v) { _mm256_storeu_pd(p, v); }
+            static inline SHELLSORT_AVX2 mask all() { return _mm256_castsi256_pd(_mm256_set1_epi32(-1)); }
+            static inline SHELLSORT_AVX2 mask land(mask a, mask b) { return _mm256_and_pd(a, b); }
+            static inline SHELLSORT_AVX2 bool any(mask m) { return _mm256_movemask_pd(m) != 0; }
+            static inline SHELLSORT_AVX2 reg select(mask m, reg t, reg f) { return _mm256_blendv_pd(f, t, m); }
+            static inline SHELLSORT_AVX2 mask lt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        };
+
+        template<class Mask>
+        struct Avx512Int {
+            using reg = __m512i;
+            using mask = Mask;
+
+            template<class V>
+            static inline SHELLSORT_AVX512 reg load(const V *p) { return _mm512_loadu_si512(p); }
+            template<class V>
+            static inline SHELLSORT_AVX512 void store(V *p, reg v) { _mm512_storeu_si512(p, v); }
+            static inline SHELLSORT_AVX512 mask all() { return mask(~mask(0)); }
+            static inline SHELLSORT_AVX512 mask land(mask a, mask b) { return mask(a & b); }
+            static inline SHELLSORT_AVX512 bool any(mask m) { return m != 0; }
+        };
+
+        template<>
+        struct Ops<Avx512, 4, 0> : Avx512Int<__mmask16> {
+            static constexpr std::size_t lanes = 16;
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_epi32(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmplt_epi32_mask(a, b); }
+        };
+
+        template<>
+        struct Ops<Avx512, 4, 1> : Avx512Int<__mmask16> {
+            static constexpr std::size_t lanes = 16;
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_epi32(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmplt_epu32_mask(a, b); }
+        };
+
+        template<>
+        struct Ops<Avx512, 8, 0> : Avx512Int<__mmask8> {
+            static constexpr std::size_t lanes = 8;
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_epi64(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmplt_epi64_mask(a, b); }
+        };
+
+        template<>
+        struct Ops<Avx512, 8, 1> : Avx512Int<__mmask8> {
+            static constexpr std::size_t lanes = 8;
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_epi64(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmplt_epu64_mask(a, b); }
+        };
+
+        template<>
+        struct Ops<Avx512, 4, 2> {
+            using reg = __m512;
+            using mask = __mmask16;
+            static constexpr std::size_t lanes = 16;
+
+            static inline SHELLSORT_AVX512 reg load(const float *p) { return _mm512_loadu_ps(p); }
+            static inline SHELLSORT_AVX512 void store(float *p, reg v) { _mm512_storeu_ps(p, v); }
+            static inline SHELLSORT_AVX512 mask all() { return mask(0xffff); }
+            static inline SHELLSORT_AVX512 mask land(mask a, mask b) { return mask(a & b); }
+            static inline SHELLSORT_AVX512 bool any(mask m) { return m != 0; }
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_ps(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+        };
+
+        template<>
+        struct Ops<Avx512, 8, 2> {
+            using reg = __m512d;
+            using mask = __mmask8;
+            static constexpr std::size_t lanes = 8;
+
+            static inline SHELLSORT_AVX512 reg load(const double *p) { return _mm512_loadu_pd(p); }
+            static inline SHELLSORT_AVX512 void store(double *p, reg v) { _mm512_storeu_pd(p, v); }
+            static inline SHELLSORT_AVX512 mask all() { return mask(0xff); }
+            static inline SHELLSORT_AVX512 mask land(mask a, mask b) { return mask(a & b); }
+            static inline SHELLSORT_AVX512 bool any(mask m) { return m != 0; }
+            static inline SHELLSORT_AVX512 reg select(mask m, reg t, reg f) { return _mm512_mask_blend_pd(m, f, t); }
+            static inline SHELLSORT_AVX512 mask lt(reg a, reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+        };
+
+        // One scalar insertion, for the elements the vectors leave over.
+        template<bool Greater, class V, class T>
+        inline void insert_scalar(V *const h, V *const i, const T gap) noexcept {
+            if (before<Greater>(*i, *(i - gap))) {
+                const V v = *i;
+                V *j = i;
+
+                do {
+                    *j = *(j - gap);
+                    j -= gap;
+                } while (j >= h && before<Greater>(v, *(j - gap)));
+
+                *j = v;
+            }
+        }
+
+        // Inserts the elements at [lo, hi) into their chains, `lanes`
+        // neighbouring elements at once. They belong to different chains
+        // whenever gap >= lanes, so each lane runs its own insertion and
+        // drops out of the loop once its element has settled. A vector that
+        // walks down to the first row may straddle it: its lanes past
+        // first + gap still have predecessors, and are finished one by one.
+        // The body is stamped out once per instruction set because the
+        // target attribute has to be spelled on the function itself.
+#define SHELLSORT_SIMD_SPAN(NAME, TARGET)                                                               \
+        template<class Ops, bool Greater, class V, class T>                                             \
+        __attribute__((target(TARGET)))                                                                 \
+        void NAME(V *first, const T gap, const T lo, const T hi) noexcept {                             \
+            constexpr T lanes = T(Ops::lanes);                                                          \
+            V *const h = first + gap;                                                                   \
+            V *i = first + lo;                                                                          \
+            V *const end = first + hi;                                                                  \
+                                                                                                        \
+            for (; end - i >= lanes; i += lanes) {                                                      \
+                const auto v = Ops::load(i);                                                            \
+                auto prev = Ops::load(i - gap);                                                         \
+                auto move = Greater ? Ops::lt(prev, v) : Ops::lt(v, prev);                              \
+                                                                                                        \
+                if (!Ops::any(move))                                                                    \
+                    continue;                                                                           \
+                                                                                                        \
+                auto active = Ops::all();                                                               \
+                auto cur = v;                                                                           \
+                V *j = i;                                                                               \
+                                                                                                        \
+                for (;;) {                                                                              \
+                    Ops::store(j, Ops::select(move, prev, Ops::select(active, v, cur)));                \
+                    active = move;                                                                      \
+                    cur = prev;                                                                         \
+                    j -= gap;                                                                           \
+                                                                                                        \
+                    if (j < h)                                                                          \
+                        break;                                                                          \
+                                                                                                        \
+                    prev = Ops::load(j - gap);                                                          \
+                    move = Ops::land(active, Greater ? Ops::lt(prev, v) : Ops::lt(v, prev));            \
+                                                                                                        \
+                    if (!Ops::any(move))                                                                \
+                        break;                                                                          \
+                }                                                                                       \
+                                                                                                        \
+                Ops::store(j, Ops::select(active, v, cur));                                             \
+                                                                                                        \
+                if (j < h) {                                                                            \
+                    for (V *k = h; k < j + lanes; k++)                                                  \
+                        insert_scalar<Greater>(h, k, gap);                                              \
+                }                                                                                       \
+            }                                                                                           \
+                                                                                                        \
+            for (; i < end; i++)                                                                        \
+                insert_scalar<Greater>(h, i, gap);                                                      \
+        }
+
+        SHELLSORT_SIMD_SPAN(span_avx2, "avx2")
+        SHELLSORT_SIMD_SPAN(span_avx512, "avx512f")
+
+#undef SHELLSORT_SIMD_SPAN
+#undef SHELLSORT_AVX2
+#undef SHELLSORT_AVX512
+
+        // Inserts [lo, hi) with the widest kernel the CPU and the gap allow;
+        // false means the caller has to run the scalar insertion.
+        template<class V, class Compare, class T>
+        bool insert_span(V *first, const T gap, const T lo, const T hi, const Level level = cpu_level()) noexcept {
+            constexpr bool greater = direction<Compare, V>::value == 2;
+
+            switch (level) {
+                case Level::avx512:
+                    if (gap >= T(64 / sizeof(V))) {
+                        span_avx512<Ops<Avx512, sizeof(V), kind<V>>, greater>(first, gap, lo, hi);
+                        return true;
+                    }
+                    [[fallthrough]];
+                case Level::avx2:
+                    if (gap >= T(32 / sizeof(V))) {
+                        span_avx2<Ops<Avx2, sizeof(V), kind<V>>, greater>(first, gap, lo, hi);
+                        return true;
+                    }
+                    [[fallthrough]];
+                default:
+                    return false;
+            }
+        }
+#else
+        template<class V, class Compare, class T>
+        bool insert_span(V *, const T, const T, const T) noexcept {
+            return false;
+        }
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef SORTINGNETWORK_HPP
+#define SORTINGNETWORK_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace ShellSortTemplate {
+    namespace Network {
+        // Largest array sorted by a network.
+        constexpr std::size_t max_size = 32;
+
+        // Batcher's odd-even merge sort for the next power of two above n,
+        // pruned to the comparators inside the first n positions; the pruned
+        // ones would only meet +inf padding and never swap. Calls emit(i, j)
+        // for every comparator, i < j.
+        template<class Emit>
+        constexpr void batcher(const std::size_t n, Emit emit) {
+            std::size_t padded = 1;
+            while (padded < n)
+                padded *= 2;
+
+            for (std::size_t p = 1; p < padded; p *= 2) {
+                for (std::size_t k = p; k >= 1; k /= 2) {
+                    for (std::size_t j = k % p; j + k < padded; j += 2 * k) {
+                        for (std::size_t i = 0; i < k && i + j + k < padded; i++) {
+                            if ((i + j) / (2 * p) == (i + j + k) / (2 * p) && i + j + k < n)
+                                emit(i + j, i + j + k);
+                        }
+                    }
+                }
+            }
+        }
+
+        constexpr std::size_t table_size(const std::size_t n) {
+            std::size_t size = 0;
+            batcher(n, [&size](std::size_t, std::size_t) { size++; });
+            return size;
+        }
+
+        // Comparator (i, j) packed as i << 8 | j.
+        template<std::size_t N>
+        constexpr std::array<std::size_t, table_size(N)> table() {
+            std::array<std::size_t, table_size(N)> pairs{};
+            std::size_t k = 0;
+
+            batcher(N, [&pairs, &k](std::size_t i, std::size_t j) { pairs[k++] = i << 8 | j; });
+            return pairs;
+        }
+
+        template<std::size_t N>
+        constexpr auto pairs = table<N>();
+
+        template<std::size_t N>
+        class Sequence {
+            // Batcher odd-even merge network generator
+            //
+
+            template<std::size_t ...I>
+            static constexpr decltype(auto) gen_seq(std::index_sequence<I...>) {
+                return std::integer_sequence<std::size_t, pairs<N>[I]...>{};
+            }
+
+            public:
+            using type = decltype(gen_seq(std::make_index_sequence<table_size(N)>()));
+        };
+
+        // The networks for every size up to max_size back to back, and where
+        // the one for size n starts: the schedule one loop walks for any size.
+        constexpr std::size_t schedule_size() {
+            std::size_t total = 0;
+            for (std::size_t n = 0; n <= max_size; n++)
+                total += table_size(n);
+            return total;
+        }
+
+        struct Schedule {
+            std::array<std::uint16_t, schedule_size()> pairs{};
+            std::array<std::uint16_t, max_size + 2> start{};
+        };
+
+        constexpr Schedule schedule() {
+            Schedule s{};
+            std::size_t k = 0;
+
+            for (std::size_t n = 0; n <= max_size; n++) {
+                s.start[n] = std::uint16_t(k);
+                batcher(n, [&s, &k](std::size_t i, std::size_t j) { s.pairs[k++] = std::uint16_t(i << 8 | j); });
+            }
+
+            s.start[max_size + 1] = std::uint16_t(k);
+            return s;
+        }
+
+        inline constexpr Schedule schedules = schedule();
+
+        // Small trivially copyable elements are exchanged through selects, so
+        // the whole network runs without a branch.
+        template<bool Select, class Iterator, class Compare>
+        constexpr void exchange(Iterator first, Compare &comp, const std::size_t i, const std::size_t j) noexcept {
+            auto &a = *(first + i);
+            auto &b = *(first + j);
+
+            if constexpr (Select) {
+                const auto x = a, y = b;
+                const bool swap = comp(y, x);
+
+                a = swap ? y : x;
+                b = swap ? x : y;
+            } else if (comp(b, a)) {
+                std::swap(a, b);
+            }
+        }
+
+        template<bool Select, class Iterator, class Compare, std::size_t ...P>
+        constexpr void apply([[maybe_unused]] Iterator first, [[maybe_unused]] Compare &comp, std::integer_sequence<std::size_t, P...>) noexcept {
+            (exchange<Select>(first, comp, P >> 8, P & 0xff), ...);
+        }
+
+        template<std::size_t N, bool Select, class Iterator, class Compare>
+        void run(Iterator first, Compare &comp) noexcept {
+            apply<Select>(first, comp, typename Sequence<N>::type{});
+        }
+
+        template<std::size_t Limit, bool Select, class Iterator, class Compare, std::size_t ...N>
+        void sort(Iterator first, Compare &comp, const std::size_t size, std::index_sequence<N...>) noexcept {
+            using Run = void (*)(Iterator, Compare &);
+            static constexpr Run networks[] = {&run<N, Select, Iterator, Compare>...};
+
+            networks[size](first, comp);
+        }
+
+        // Sorts [first, first + size), size <= Limit <= max_size, with the
+        // network for its size: Unrolled stamps out every network up to Limit
+        // as straight-line code, otherwise one loop walks the schedule.
+        template<std::size_t Limit, bool Select, bool Unrolled, class Iterator, class Compare>
+        void sort(Iterator first, Compare &comp, const std::size_t size) noexcept {
+            static_assert(Limit <= max_size, "no networks generated past max_size");
+
+            if constexpr (Unrolled) {
+                sort<Limit, Select>(first, comp, size, std::make_index_sequence<Limit + 1>());
+            } else {
+                for (std::size_t k = schedules.start[size]; k < schedules.start[size + 1]; k++)
+                    exchange<Select>(first, comp, schedules.pairs[k] >> 8, schedules.pairs[k] & 0xff);
+            }
+        }
+    }
+}
+
+#endif
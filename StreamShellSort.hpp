@@ -0,0 +1,187 @@
+#ifndef STREAMSHELLSORT_HPP
+#define STREAMSHELLSORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace StreamSortNS {
+    // A sorted view of a Buffer, valid until its next append.
+    template<class T>
+    struct View {
+        const T *first;
+        const T *last;
+
+        const T *begin() const noexcept { return first; }
+        const T *end() const noexcept { return last; }
+        std::size_t size() const noexcept { return std::size_t(last - first); }
+        bool empty() const noexcept { return first == last; }
+        const T &operator[](const std::size_t i) const noexcept { return first[i]; }
+    };
+
+    // A buffer that data is appended to in batches and read in order. Each
+    // batch is shell sorted with `Sequence` and kept as a sorted run behind
+    // the others; runs are merged as they come, the last ones first, so that
+    // every run is longer than the two after it together. Run lengths then
+    // grow at least as fast as the Fibonacci numbers, there are O(log n) of
+    // them, and an element is moved O(log n) times over all appends. A merge
+    // skips the front of the left run and the back of the right run that
+    // are already in place, so batches that come in order, such as
+    // timestamps, are not moved at all. Equal elements of different batches
+    // keep the order they were appended in.
+    template<class T, class Sequence = FibFuzzyNS::Sequence<std::ptrdiff_t>, class Comparator = std::less<>, class Policy = ShellSortTemplate::DefaultPolicy>
+    class Buffer {
+        std::vector<T> data;
+        std::vector<std::size_t> ends;  // end of every run, the first starts at 0
+        std::vector<T> scratch;
+        Comparator comp;
+
+        std::size_t start(const std::size_t r) const noexcept {
+            return r ? ends[r - 1] : 0;
+        }
+
+        std::size_t length(const std::size_t r) const noexcept {
+            return ends[r] - start(r);
+        }
+
+        // Merges run r with run r + 1, buffering the shorter of the two.
+        void merge(const std::size_t r) {
+            T *const base = data.data();
+            T *lo = base + start(r);
+            T *const mid = base + ends[r];
+            T *hi = base + ends[r + 1];
+
+            ends.erase(ends.begin() + std::ptrdiff_t(r));
+
+            lo = std::upper_bound(lo, mid, *mid, comp);
+            if (lo == mid)
+                return;
+            hi = std::lower_bound(mid, hi, mid[-1], comp);
+
+            if (mid - lo <= hi - mid) {
+                scratch.assign(std::make_move_iterator(lo), std::make_move_iterator(mid));
+
+                T *l = scratch.data(), *const le = l + scratch.size();
+                T *r = mid, *out = lo;
+
+                while (l != le && r != hi)
+                    *out++ = comp(*r, *l) ? std::move(*r++) : std::move(*l++);
+
+                std::move(l, le, out);
+            } else {
+                scratch.assign(std::make_move_iterator(mid), std::make_move_iterator(hi));
+
+                T *const rs = scratch.data();
+                T *r = rs + scratch.size();
+                T *l = mid, *out = hi;
+
+                while (l != lo && r != rs)
+                    *--out = comp(r[-1], l[-1]) ? std::move(*--l) : std::move(*--r);
+
+                std::move_backward(rs, r, out);
+            }
+
+            scratch.clear();
+        }
+
+        // Restores the run lengths after an append; with `all`, merges
+        // everything into one run.
+        void collapse(const bool all) {
+            while (ends.size() > 1) {
+                std::size_t n = ends.size() - 2;
+
+                if ((n > 0 && length(n - 1) <= length(n) + length(n + 1)) ||
+                    (n > 1 && length(n - 2) <= length(n - 1) + length(n))) {
+                    if (length(n - 1) < length(n + 1))
+                        n--;
+                } else if (!all && length(n) > length(n + 1)) {
+                    break;
+                }
+
+                merge(n);
+            }
+        }
+
+        public:
+        explicit Buffer(Comparator comp = Comparator()) : comp(comp) {}
+
+        void reserve(const std::size_t capacity) {
+            data.reserve(capacity);
+        }
+
+        // Appends [first, last) as one batch.
+        template<class Iterator>
+        void append(Iterator first, Iterator last) {
+            const std::size_t from = data.size();
+
+            data.insert(data.end(), first, last);
+
+            if (data.size() == from)
+                return;
+
+            ShellSortTemplate::sort<T *, Sequence, Comparator, Policy>(data.data() + from, data.data() + data.size(), comp);
+            ends.push_back(data.size());
+            collapse(false);
+        }
+
+        std::size_t size() const noexcept {
+            return data.size();
+        }
+
+        bool empty() const noexcept {
+            return data.empty();
+        }
+
+        // Number of sorted runs the data is held in.
+        std::size_t runs() const noexcept {
+            return ends.size();
+        }
+
+        void clear() noexcept {
+            data.clear();
+            ends.clear();
+        }
+
+        // Merges the runs into one and returns it.
+        View<T> sorted() {
+            collapse(true);
+            return {data.data(), data.data() + data.size()};
+        }
+
+        std::vector<T> snapshot() {
+            const View<T> view = sorted();
+            return {view.begin(), view.end()};
+        }
+
+        // Calls visit on every element in order without merging the runs,
+        // at the cost of a comparison per run and element.
+        template<class Visit>
+        void for_each(Visit visit) {
+            std::vector<std::pair<const T *, const T *>> heads;
+
+            for (std::size_t r = 0; r < ends.size(); r++)
+                heads.emplace_back(data.data() + start(r), data.data() + ends[r]);
+
+            while (!heads.empty()) {
+                std::size_t min = 0;
+
+                for (std::size_t h = 1; h < heads.size(); h++)
+                    if (comp(*heads[h].first, *heads[min].first))
+                        min = h;
+
+                visit(*heads[min].first++);
+
+                if (heads[min].first == heads[min].second)
+                    heads.erase(heads.begin() + std::ptrdiff_t(min));
+            }
+        }
+    };
+
+};
+
+#endif
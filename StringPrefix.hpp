@@ -0,0 +1,74 @@
+#ifndef STRINGPREFIX_HPP
+#define STRINGPREFIX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "SimdGapPass.hpp"
+
+namespace ShellSortTemplate {
+    namespace Strings {
+        template<class V>
+        struct is_string : std::false_type {};
+
+        template<class Traits, class Alloc>
+        struct is_string<std::basic_string<char, Traits, Alloc>> : std::is_same<Traits, std::char_traits<char>> {};
+
+        template<>
+        struct is_string<std::string_view> : std::true_type {};
+
+        // Ranges of std::string or std::string_view ordered by std::less or
+        // std::greater, whose order is plain unsigned byte order.
+        template<class Iterator, class Compare>
+        constexpr bool supported = is_string<typename std::iterator_traits<Iterator>::value_type>::value &&
+                                   Simd::direction<Compare, typename std::iterator_traits<Iterator>::value_type>::value != 0;
+
+        // Bytes of a string packed into one key per round. The low byte of
+        // the key counts the bytes the string still had, or is key_bytes + 1
+        // when it goes on, so a string sorts before its extensions and equal
+        // keys below that mark equal strings.
+        constexpr std::size_t key_bytes = 7;
+
+        // The bytes of s from `offset` on as a big-endian key, zero padded,
+        // so integer order is byte order.
+        inline std::uint64_t key(const std::string_view s, const std::size_t offset) noexcept {
+            const std::size_t rest = s.size() > offset ? s.size() - offset : 0;
+            const std::size_t n = std::min(key_bytes, rest);
+            std::uint64_t key = 0;
+
+            for (std::size_t k = 0; k < n; k++)
+                key |= std::uint64_t(static_cast<unsigned char>(s[offset + k])) << (56 - 8 * k);
+
+            return key | (rest > key_bytes ? key_bytes + 1 : rest);
+        }
+
+        constexpr bool continues(const std::uint64_t key) noexcept {
+            return (key & 0xff) > key_bytes;
+        }
+
+        // Number of bytes after `offset` that the strings of the entries
+        // all share; the next keys are cut after them, so a common date,
+        // scheme or host costs nothing.
+        template<class Iterator, class Entry>
+        std::size_t common_prefix(Iterator first, const Entry *entries, const std::size_t size, const std::size_t offset) noexcept {
+            const std::string_view head = *(first + entries[0].index);
+            std::size_t common = head.size() - offset;
+
+            for (std::size_t i = 1; i < size && common > 0; i++) {
+                const std::string_view s = *(first + entries[i].index);
+                const auto h = head.begin() + offset;
+
+                common = std::min(common, s.size() - offset);
+                common = std::size_t(std::mismatch(h, h + common, s.begin() + offset).first - h);
+            }
+
+            return common;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef ZIPSHELLSORT_HPP
+#define ZIPSHELLSORT_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "ShellSortTemplate.hpp"
+#include "FibFuzzyShellSort.hpp"
+
+namespace ZipSortNS {
+    // Moves the element at i of a payload column up its chain to j, the
+    // place its key was inserted at.
+    template<class Column, class T>
+    constexpr void rotate_chain(Column column, const T j, const T i, const T gap) noexcept {
+        auto v = std::move(*(column + i));
+
+        for (T k = i; k != j; k -= gap)
+            *(column + k) = std::move(*(column + (k - gap)));
+
+        *(column + j) = std::move(v);
+    }
+
+    // Inserts the keys at [lo, hi) into their chains; every payload column
+    // then replays the same shift on plain iterators, so the hot loop never
+    // sees a proxy or a temporary record.
+    template<class Iterator, class Compare, class T, class ...Columns>
+    constexpr void insert_span(Iterator keys, Compare &comp, const T gap, const T lo, const T hi, Columns ...columns) noexcept {
+        for (T i = lo; i < hi; i++) {
+            if (!comp(*(keys + i), *(keys + (i - gap))))
+                continue;
+
+            auto v = std::move(*(keys + i));
+            T j = i;
+
+            do {
+                *(keys + j) = std::move(*(keys + (j - gap)));
+                j -= gap;
+            } while (j >= gap && comp(v, *(keys + (j - gap))));
+
+            *(keys + j) = std::move(v);
+            (rotate_chain(columns, j, i, gap), ...);
+        }
+    }
+
+    template<class Iterator, class Compare, class T, class ...Columns>
+    constexpr void sort_columns(Iterator keys, Compare comp, const T size, const T gap, const T col_first, const T col_last, Columns ...columns) noexcept {
+        if (col_first == 0 && col_last == gap) {
+            insert_span(keys, comp, gap, gap, size, columns...);
+            return;
+        }
+
+        for (T base = gap; size - base > col_first; base += gap) {
+            insert_span(keys, comp, gap, base + col_first, base + std::min(col_last, size - base), columns...);
+
+            if (size - base <= gap)
+                break;
+        }
+    }
+
+    template<class Iterator, class Compare, class T, T ...Seq, class ...Columns>
+    void sort_impl(Iterator keys, Compare comp, const T size, std::integer_sequence<T, Seq...>, const unsigned threads, Columns ...columns) noexcept {
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        constexpr T min_width = T(std::max<std::size_t>(1, ShellSortTemplate::parallel_block_bytes / sizeof(value_type)));
+
+        const auto scan = ShellSortTemplate::presortedness(keys, comp, size);
+
+        if (scan.ascending)
+            return;
+
+        if (scan.descending) {
+            std::reverse(keys, keys + size);
+            (std::reverse(columns, columns + size), ...);
+            return;
+        }
+
+        for (const auto gap : {Seq...}) {
+            if (size > gap && scan.reach >= gap) {
+                ShellSortTemplate::for_column_blocks(size, gap, threads, min_width, [=](T col_first, T col_last) {
+                    sort_columns(keys, comp, size, gap, col_first, col_last, columns...);
+                });
+            }
+        }
+    }
+
+    // Sorts the key column [first, last) and permutes every payload column,
+    // each given by the iterator to its first element, the same way.
+    template<class Sequence, class Iterator, class Comparator, class ...Columns>
+    void sort(Iterator first, Iterator last, Comparator comp, unsigned threads, Columns ...columns) noexcept {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const auto size = std::distance(first, last);
+        using Table = typename ShellSortTemplate::rebind_sequence<Sequence, std::remove_const_t<decltype(size)>>::type::type;
+
+        if (size > 1)
+            sort_impl(ShellSortTemplate::unwrap(first, last), comp, size, Table{}, threads, ShellSortTemplate::unwrap(columns, std::next(columns, size))...);
+    }
+
+    template<class Iterator, class ...Columns>
+    void shellsort(Iterator first, Iterator last, Columns ...columns) noexcept {
+        using Sequence = FibFuzzyNS::Sequence<typename std::iterator_traits<Iterator>::difference_type>;
+
+        sort<Sequence>(first, last, std::less<>(), 1, columns...);
+    }
+
+};
+
+#endif